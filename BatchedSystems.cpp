@@ -0,0 +1,169 @@
+#include "BatchedSystems.h"
+#include "Simulation.h"
+#include <cmath>
+#if defined(__AVX__)
+#include <immintrin.h>
+#endif
+
+BatchedSystems::BatchedSystems(u32 nrOfBodies, u32 nrOfSystems)
+{
+	this->nrOfBodies = nrOfBodies;
+	this->nrOfSystems = nrOfSystems;
+
+	//Pad to whole vectors. Unused lanes hold massless bodies on a circular orbit of radius 1 around a Sun of mass 1,
+	//so they stay finite and never divide by zero.
+	lanes = (nrOfSystems + BATCH_LANES - 1) / BATCH_LANES * BATCH_LANES;
+
+	u32 size = nrOfBodies * lanes;
+	sunMu.assign(lanes, G);
+	mass.assign(size, 0);
+	x.assign(size, 1);
+	y.assign(size, 0);
+	z.assign(size, 0);
+	vx.assign(size, 0);
+	vy.assign(size, sqrt(G));
+	vz.assign(size, 0);
+	ax.assign(size, 0);
+	ay.assign(size, 0);
+	az.assign(size, 0);
+}
+
+void BatchedSystems::setSystem(u32 system, const array<Body>& bodies)
+{
+	sunMu[system] = G * bodies[0].mass;
+
+	for (u32 b = 0; b < nrOfBodies; b++)
+	{
+		u32 i = b * lanes + system;
+		mass[i] = bodies[b].mass;
+		x[i] = bodies[b].position.X;
+		y[i] = bodies[b].position.Y;
+		z[i] = bodies[b].position.Z;
+		vx[i] = bodies[b].velocity.X;
+		vy[i] = bodies[b].velocity.Y;
+		vz[i] = bodies[b].velocity.Z;
+	}
+
+	for (u32 b = 1; b < nrOfBodies; b++)
+	{
+		computeAccelerations(b);
+	}
+}
+
+void BatchedSystems::getBody(u32 system, u32 body, Body& state) const
+{
+	u32 i = body * lanes + system;
+	state.position = vector3d<double>(x[i], y[i], z[i]);
+	state.velocity = vector3d<double>(vx[i], vy[i], vz[i]);
+}
+
+void BatchedSystems::computeAccelerations(u32 body)
+{
+	u32 offset = body * lanes;
+	for (u32 k = 0; k < lanes; k++)
+	{
+		u32 i = offset + k;
+		double r2 = x[i] * x[i] + y[i] * y[i] + z[i] * z[i];
+		double factor = -sunMu[k] / (r2 * sqrt(r2));
+		ax[i] = x[i] * factor;
+		ay[i] = y[i] * factor;
+		az[i] = z[i] * factor;
+	}
+}
+
+void BatchedSystems::step(double timeStep)
+{
+	double halfStepSquared = 0.5 * timeStep * timeStep;
+	double halfStep = 0.5 * timeStep;
+
+	//The Sun (body 0) is fixed, so only the planets move.
+	for (u32 b = 1; b < nrOfBodies; b++)
+	{
+		double* px = &x[b * lanes];
+		double* py = &y[b * lanes];
+		double* pz = &z[b * lanes];
+		double* pvx = &vx[b * lanes];
+		double* pvy = &vy[b * lanes];
+		double* pvz = &vz[b * lanes];
+		double* pax = &ax[b * lanes];
+		double* pay = &ay[b * lanes];
+		double* paz = &az[b * lanes];
+		const double* mu = &sunMu[0];
+		u32 k = 0;
+
+#if defined(__AVX__)
+		const __m256d dt = _mm256_set1_pd(timeStep);
+		const __m256d hdt2 = _mm256_set1_pd(halfStepSquared);
+		const __m256d hdt = _mm256_set1_pd(halfStep);
+		for (; k < lanes; k += 4)
+		{
+			__m256d oldAx = _mm256_loadu_pd(pax + k);
+			__m256d oldAy = _mm256_loadu_pd(pay + k);
+			__m256d oldAz = _mm256_loadu_pd(paz + k);
+			__m256d velX = _mm256_loadu_pd(pvx + k);
+			__m256d velY = _mm256_loadu_pd(pvy + k);
+			__m256d velZ = _mm256_loadu_pd(pvz + k);
+
+			__m256d posX = _mm256_add_pd(_mm256_loadu_pd(px + k), _mm256_add_pd(_mm256_mul_pd(velX, dt), _mm256_mul_pd(oldAx, hdt2)));
+			__m256d posY = _mm256_add_pd(_mm256_loadu_pd(py + k), _mm256_add_pd(_mm256_mul_pd(velY, dt), _mm256_mul_pd(oldAy, hdt2)));
+			__m256d posZ = _mm256_add_pd(_mm256_loadu_pd(pz + k), _mm256_add_pd(_mm256_mul_pd(velZ, dt), _mm256_mul_pd(oldAz, hdt2)));
+
+			__m256d r2 = _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(posX, posX), _mm256_mul_pd(posY, posY)), _mm256_mul_pd(posZ, posZ));
+			__m256d factor = _mm256_div_pd(_mm256_sub_pd(_mm256_setzero_pd(), _mm256_loadu_pd(mu + k)), _mm256_mul_pd(r2, _mm256_sqrt_pd(r2)));
+			__m256d newAx = _mm256_mul_pd(posX, factor);
+			__m256d newAy = _mm256_mul_pd(posY, factor);
+			__m256d newAz = _mm256_mul_pd(posZ, factor);
+
+			_mm256_storeu_pd(px + k, posX);
+			_mm256_storeu_pd(py + k, posY);
+			_mm256_storeu_pd(pz + k, posZ);
+			_mm256_storeu_pd(pvx + k, _mm256_add_pd(velX, _mm256_mul_pd(_mm256_add_pd(oldAx, newAx), hdt)));
+			_mm256_storeu_pd(pvy + k, _mm256_add_pd(velY, _mm256_mul_pd(_mm256_add_pd(oldAy, newAy), hdt)));
+			_mm256_storeu_pd(pvz + k, _mm256_add_pd(velZ, _mm256_mul_pd(_mm256_add_pd(oldAz, newAz), hdt)));
+			_mm256_storeu_pd(pax + k, newAx);
+			_mm256_storeu_pd(pay + k, newAy);
+			_mm256_storeu_pd(paz + k, newAz);
+		}
+#endif
+
+		//Plain lane loop, written so the compiler can vectorise it when AVX is not enabled.
+		for (; k < lanes; k++)
+		{
+			px[k] += pvx[k] * timeStep + pax[k] * halfStepSquared;
+			py[k] += pvy[k] * timeStep + pay[k] * halfStepSquared;
+			pz[k] += pvz[k] * timeStep + paz[k] * halfStepSquared;
+
+			double r2 = px[k] * px[k] + py[k] * py[k] + pz[k] * pz[k];
+			double factor = -mu[k] / (r2 * sqrt(r2));
+			double newAx = px[k] * factor;
+			double newAy = py[k] * factor;
+			double newAz = pz[k] * factor;
+
+			pvx[k] += (pax[k] + newAx) * halfStep;
+			pvy[k] += (pay[k] + newAy) * halfStep;
+			pvz[k] += (paz[k] + newAz) * halfStep;
+			pax[k] = newAx;
+			pay[k] = newAy;
+			paz[k] = newAz;
+		}
+	}
+}
+
+double BatchedSystems::energy(u32 system) const
+{
+	double energy = 0;
+	for (u32 b = 1; b < nrOfBodies; b++)
+	{
+		u32 i = b * lanes + system;
+		double v2 = vx[i] * vx[i] + vy[i] * vy[i] + vz[i] * vz[i];
+		double r = sqrt(x[i] * x[i] + y[i] * y[i] + z[i] * z[i]);
+		energy += 0.5 * mass[i] * v2 - sunMu[system] * mass[i] / r;
+	}
+	return energy;
+}
+
+double BatchedSystems::sunDistance(u32 system, u32 body) const
+{
+	u32 i = body * lanes + system;
+	return sqrt(x[i] * x[i] + y[i] * y[i] + z[i] * z[i]);
+}
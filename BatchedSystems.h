@@ -0,0 +1,38 @@
+#pragma once
+#include <vector>
+#include "Body.h"
+using namespace irr;
+using namespace core;
+
+//Number of systems advanced together. Matches eight doubles per AVX-512 register, or two AVX registers.
+const u32 BATCH_LANES = 8;
+
+//Many independent copies of the same Sun-centred system, laid out lane-wise: the state of body b in
+//system s is stored at [b * lanes + s], so every pass over a body advances all systems at once.
+class BatchedSystems
+{
+public:
+	BatchedSystems(u32 nrOfBodies, u32 nrOfSystems);
+
+	void setSystem(u32 system, const array<Body>& bodies);
+	void getBody(u32 system, u32 body, Body& state) const;
+
+	//Leapfrog (velocity Verlet) step of every planet around the fixed Sun, matching integrate() with LEAPFROG.
+	void step(double timeStep);
+
+	double energy(u32 system) const;
+	double sunDistance(u32 system, u32 body) const;
+
+	u32 nrOfBodies;
+	u32 nrOfSystems;
+	u32 lanes;
+
+private:
+	void computeAccelerations(u32 body);
+
+	std::vector<double> sunMu;
+	std::vector<double> mass;
+	std::vector<double> x, y, z;
+	std::vector<double> vx, vy, vz;
+	std::vector<double> ax, ay, az;
+};
@@ -5,38 +5,27 @@ Body::Body(stringw name,
 	vector3d<double> velocity,
 	double radius,
 	double mass,
-	io::path texturePath,
-	double distanceScale,
-	u32 fixedPlanetDrawSize,
-	IrrlichtDevice *device
+	io::path texturePath
 	)
 {
 	this->name = name;
 	this->position = position;
 	this->velocity = velocity;
+	previousPosition = position;
+	previousVelocity = velocity;
 	this->radius = radius;
 	this->mass = mass;
-	this->distanceScale = distanceScale;
-	double drawRadius;
-	if (fixedPlanetDrawSize == 0)
-	{
-		drawRadius = radius;
-	}
-	else
-	{
-		drawRadius = fixedPlanetDrawSize;
-	}
-
-	sphere = device->getSceneManager()->addSphereSceneNode(drawRadius, 128, 0, 1, vector3df(position.X, position.Y, position.Z) * distanceScale, vector3df(0), vector3df(1));
-	sphere->setMaterialFlag(irr::video::EMF_LIGHTING, false);
-	sphere->setMaterialTexture(0, device->getVideoDriver()->getTexture(texturePath));
+	removed = false;
+	this->texturePath = texturePath;
+	visual = 0;
 }
 
 Body::~Body()
 {
 }
 
-void Body::prepareDraw()
+void Body::saveState()
 {
-	sphere->setPosition(vector3df(position.X * distanceScale, position.Y * distanceScale, position.Z * distanceScale));
-}
\ No newline at end of file
+	previousPosition = position;
+	previousVelocity = velocity;
+}
@@ -1,9 +1,13 @@
 #pragma once
-#include <irrlicht.h>
-#include <string>
+#include "CoreTypes.h"
 using namespace irr;
 using namespace core;
 
+class BodyVisual;
+
+//Physical state of a body. Everything drawn for it lives in a BodyVisual owned by the renderer.
+//There is no separate snapshot for the renderer: it reads the current and previous state straight from here
+//each frame. Updates and draws take turns on the main thread, so a draw always sees a completed update.
 class Body
 {
 public:
@@ -12,21 +16,20 @@ public:
 		vector3d<double> velocity,
 		double radius,
 		double mass,
-		io::path texturePath,
-		double distanceScale,
-		u32 fixedPlanetDrawSize,
-		IrrlichtDevice *device
+		io::path texturePath
 		);
 	~Body();
-	void prepareDraw();
+	void saveState();
 	
 	vector3d<double> position;
 	vector3d<double> velocity;
+	vector3d<double> previousPosition;
+	vector3d<double> previousVelocity;
 	double mass;
 	double radius;
+	bool removed; //Only set by a replay, for times after a collision removed the body. Removed bodies are not drawn.
 
-	array<irr::scene::IMeshSceneNode*> orbitHistory;
-	double distanceScale;
 	stringw name;
-	irr::scene::IMeshSceneNode* sphere;
-};
\ No newline at end of file
+	io::path texturePath;
+	BodyVisual* visual; //0 for headless bodies and in builds without a renderer.
+};
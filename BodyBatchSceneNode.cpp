@@ -0,0 +1,160 @@
+#include "BodyBatchSceneNode.h"
+#include "Culling.h"
+
+//Sprites per draw call, the most that 16 bit indices can address.
+static const u32 SPRITES_PER_BATCH = 0x10000 / 4;
+
+BodyBatchSceneNode::BodyBatchSceneNode(scene::ISceneNode* parent, scene::ISceneManager* mgr, const array<Body*>* bodies, const RenderFrame* frame, f32 drawSize, video::SColor color)
+	: scene::ISceneNode(parent, mgr, -1)
+{
+	this->bodies = bodies;
+	this->frame = frame;
+	this->drawSize = drawSize;
+	this->color = color;
+
+	indices.set_used(SPRITES_PER_BATCH * 6);
+	for (u32 i = 0; i < SPRITES_PER_BATCH; i++)
+	{
+		indices[i * 6 + 0] = i * 4 + 0;
+		indices[i * 6 + 1] = i * 4 + 1;
+		indices[i * 6 + 2] = i * 4 + 2;
+		indices[i * 6 + 3] = i * 4 + 0;
+		indices[i * 6 + 4] = i * 4 + 2;
+		indices[i * 6 + 5] = i * 4 + 3;
+	}
+
+	//A soft round sprite, so the quads read as small bodies rather than squares.
+	video::IVideoDriver* driver = mgr->getVideoDriver();
+	const u32 spriteSize = 32;
+	video::IImage* image = driver->createImage(video::ECF_A8R8G8B8, dimension2du(spriteSize, spriteSize));
+	for (u32 y = 0; y < spriteSize; y++)
+	{
+		for (u32 x = 0; x < spriteSize; x++)
+		{
+			f32 dx = (x + 0.5f) / spriteSize * 2 - 1;
+			f32 dy = (y + 0.5f) / spriteSize * 2 - 1;
+			f32 alpha = core::clamp(1.0f - sqrtf(dx * dx + dy * dy), 0.0f, 1.0f);
+			image->setPixel(x, y, video::SColor((u32)(alpha * 255), 255, 255, 255));
+		}
+	}
+
+	material.Lighting = false;
+	material.ZWriteEnable = false;
+	material.MaterialType = video::EMT_TRANSPARENT_ALPHA_CHANNEL;
+	material.setTexture(0, driver->addTexture("body_batch_sprite", image));
+	image->drop();
+
+	//Bodies can be anywhere, so the node is never culled as a whole. render() culls each block of sprites instead.
+	setAutomaticCulling(scene::EAC_OFF);
+}
+
+void BodyBatchSceneNode::OnRegisterSceneNode()
+{
+	if (IsVisible)
+	{
+		SceneManager->registerNodeForRendering(this, scene::ESNRP_TRANSPARENT);
+	}
+
+	ISceneNode::OnRegisterSceneNode();
+}
+
+void BodyBatchSceneNode::render()
+{
+	scene::ICameraSceneNode* camera = SceneManager->getActiveCamera();
+	if (!camera)
+	{
+		return;
+	}
+
+	const matrix4& view = camera->getViewMatrix();
+	//The camera is rendered before the other nodes, so its frustum is already this frame's.
+	const scene::SViewFrustum* frustum = camera->getViewFrustum();
+	const f32 spriteRadius = drawSize * sqrtf(2.0f);
+	vector3df right = vector3df(view[0], view[4], view[8]) * drawSize;
+	vector3df up = vector3df(view[1], view[5], view[9]) * drawSize;
+
+	//Positions are gathered a block at a time and converted together, so nonlinear scaling runs as one batched transform.
+	const u32 BLOCK_SIZE = 256;
+	double x[BLOCK_SIZE];
+	double y[BLOCK_SIZE];
+	double z[BLOCK_SIZE];
+	video::S3DVertex centers[BLOCK_SIZE];
+
+	vertices.set_used(0);
+	u32 next = 0;
+	while (next < bodies->size())
+	{
+		u32 block = 0;
+		for (; next < bodies->size() && block < BLOCK_SIZE; next++)
+		{
+			const Body* body = (*bodies)[next];
+			if (body->visual || body->removed)
+			{
+				continue;
+			}
+
+			vector3d<double> position = frame->drawPosition(body);
+			x[block] = position.X;
+			y[block] = position.Y;
+			z[block] = position.Z;
+			block++;
+		}
+		if (block == 0)
+		{
+			continue;
+		}
+		frame->toRender(x, y, z, block, centers);
+
+		//A block whose bounds are outside the frustum is skipped whole, otherwise each sprite is tested on its own.
+		aabbox3df blockBox(centers[0].Pos);
+		for (u32 i = 1; i < block; i++)
+		{
+			blockBox.addInternalPoint(centers[i].Pos);
+		}
+		blockBox.MinEdge -= vector3df(spriteRadius);
+		blockBox.MaxEdge += vector3df(spriteRadius);
+		if (boxOutside(*frustum, blockBox))
+		{
+			continue;
+		}
+
+		for (u32 i = 0; i < block; i++)
+		{
+			const vector3df& center = centers[i].Pos;
+			if (sphereOutside(*frustum, center, spriteRadius))
+			{
+				continue;
+			}
+			vertices.push_back(video::S3DVertex(center - right - up, vector3df(0), color, vector2df(0, 1)));
+			vertices.push_back(video::S3DVertex(center - right + up, vector3df(0), color, vector2df(0, 0)));
+			vertices.push_back(video::S3DVertex(center + right + up, vector3df(0), color, vector2df(1, 0)));
+			vertices.push_back(video::S3DVertex(center + right - up, vector3df(0), color, vector2df(1, 1)));
+		}
+	}
+
+	video::IVideoDriver* driver = SceneManager->getVideoDriver();
+	driver->setMaterial(material);
+	driver->setTransform(video::ETS_WORLD, IdentityMatrix);
+
+	u32 sprites = vertices.size() / 4;
+	for (u32 first = 0; first < sprites; first += SPRITES_PER_BATCH)
+	{
+		u32 count = core::min_(SPRITES_PER_BATCH, sprites - first);
+		driver->drawVertexPrimitiveList(vertices.const_pointer() + first * 4, count * 4, indices.const_pointer(), count * 2, video::EVT_STANDARD, scene::EPT_TRIANGLES, video::EIT_16BIT);
+	}
+}
+
+const aabbox3df& BodyBatchSceneNode::getBoundingBox() const
+{
+	return box;
+}
+
+u32 BodyBatchSceneNode::getMaterialCount() const
+{
+	return 1;
+}
+
+video::SMaterial& BodyBatchSceneNode::getMaterial(u32 /*i*/)
+{
+	return material;
+}
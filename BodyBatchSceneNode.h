@@ -0,0 +1,31 @@
+#pragma once
+#include <irrlicht.h>
+#include "Body.h"
+#include "RenderFrame.h"
+using namespace irr;
+using namespace core;
+
+//Draws every headless body (one without its own sphere node) as a camera facing sprite.
+//All sprites are written into one vertex array per frame and drawn a few thousand at a time
+//from a shared index list, instead of one scene node per body.
+class BodyBatchSceneNode : public scene::ISceneNode
+{
+public:
+	BodyBatchSceneNode(scene::ISceneNode* parent, scene::ISceneManager* mgr, const array<Body*>* bodies, const RenderFrame* frame, f32 drawSize, video::SColor color);
+
+	virtual void OnRegisterSceneNode();
+	virtual void render();
+	virtual const aabbox3df& getBoundingBox() const;
+	virtual u32 getMaterialCount() const;
+	virtual video::SMaterial& getMaterial(u32 i);
+
+private:
+	const array<Body*>* bodies;
+	const RenderFrame* frame;
+	f32 drawSize;
+	video::SColor color;
+	array<video::S3DVertex> vertices;
+	array<u16> indices;
+	aabbox3df box;
+	video::SMaterial material;
+};
@@ -0,0 +1,219 @@
+#include "BodyPicker.h"
+#include <cmath>
+
+static const u32 NO_CELL = 0xFFFFFFFF;
+
+BodyPicker::BodyPicker(u32 cellSize, f32 minPixelRadius)
+{
+	this->cellSize = core::max_<u32>(cellSize, 1);
+	this->minPixelRadius = minPixelRadius;
+	bodies = 0;
+	pixelsPerUnit = 0;
+	columns = 0;
+	rows = 0;
+}
+
+bool BodyPicker::project(const vector3df& position, Projected& result) const
+{
+	f32 clip[4] = { position.X, position.Y, position.Z, 1 };
+	viewProjection.multiplyWith1x4Matrix(clip);
+
+	//Behind the camera or on its plane.
+	if (clip[3] <= 0)
+	{
+		return false;
+	}
+
+	result.x = (clip[0] / clip[3] * 0.5f + 0.5f) * screenSize.Width;
+	result.y = (0.5f - clip[1] / clip[3] * 0.5f) * screenSize.Height;
+	result.depth = clip[3];
+	return true;
+}
+
+void BodyPicker::build(const array<Body*>& bodies, const RenderFrame& frame, scene::ICameraSceneNode* camera, const dimension2d<u32>& screenSize)
+{
+	this->bodies = &bodies;
+	this->screenSize = screenSize;
+
+	matrix4 view;
+	view.buildCameraLookAtMatrixLH(camera->getAbsolutePosition(), camera->getTarget(), camera->getUpVector());
+	viewProjection = camera->getProjectionMatrix() * view;
+	pixelsPerUnit = screenSize.Height * 0.5f / tanf(camera->getFOV() * 0.5f);
+
+	columns = (screenSize.Width + cellSize - 1) / cellSize;
+	rows = (screenSize.Height + cellSize - 1) / cellSize;
+	cellStart.set_used(columns * rows + 1);
+	for (u32 i = 0; i < cellStart.size(); i++)
+	{
+		cellStart[i] = 0;
+	}
+	oversized.set_used(0);
+	trailBodies.set_used(0);
+
+	//Positions drawn this frame, relative to the camera since the render origin follows it. Bodies no larger
+	//than a cell are binned by their centre, so a point only has to look at its own and the neighbouring cells.
+	projected.set_used(bodies.size());
+	for (u32 i = 0; i < bodies.size(); i++)
+	{
+		const BodyVisual* visual = bodies[i]->visual;
+		if (visual && !bodies[i]->removed && (visual->orbitTrail || visual->orbitEllipse))
+		{
+			trailBodies.push_back(i);
+		}
+
+		Projected& p = projected[i];
+		p.cell = NO_CELL;
+		if (bodies[i]->removed || !project(frame.toRender(frame.drawPosition(bodies[i])), p))
+		{
+			continue;
+		}
+
+		//Bodies without a visual are drawn at a fixed size on screen, whatever their radius.
+		p.radius = visual ? core::max_((f32)visual->drawRadius / p.depth * pixelsPerUnit, minPixelRadius) : minPixelRadius;
+		if (p.x + p.radius < 0 || p.y + p.radius < 0 || p.x - p.radius >= screenSize.Width || p.y - p.radius >= screenSize.Height)
+		{
+			continue;
+		}
+
+		if (p.radius > cellSize)
+		{
+			oversized.push_back(i);
+			continue;
+		}
+
+		s32 x = core::clamp((s32)floorf(p.x / cellSize), 0, (s32)columns - 1);
+		s32 y = core::clamp((s32)floorf(p.y / cellSize), 0, (s32)rows - 1);
+		p.cell = y * columns + x;
+		cellStart[p.cell + 1]++;
+	}
+
+	//Counting sort: the counts become start offsets, then each body is placed at its cell's next free slot.
+	for (u32 c = 1; c < cellStart.size(); c++)
+	{
+		cellStart[c] += cellStart[c - 1];
+	}
+	cellBodies.set_used(cellStart[cellStart.size() - 1]);
+	for (u32 i = 0; i < projected.size(); i++)
+	{
+		if (projected[i].cell != NO_CELL)
+		{
+			cellBodies[cellStart[projected[i].cell]++] = i;
+		}
+	}
+
+	//Filling advanced every start to the next cell's start, so shift them back.
+	for (u32 c = cellStart.size() - 1; c > 0; c--)
+	{
+		cellStart[c] = cellStart[c - 1];
+	}
+	cellStart[0] = 0;
+}
+
+Body* BodyPicker::pick(const position2di& point) const
+{
+	if (!bodies || point.X < 0 || point.Y < 0 || (u32)point.X >= screenSize.Width || (u32)point.Y >= screenSize.Height)
+	{
+		return 0;
+	}
+
+	s32 nearest = -1;
+	f32 nearestDepth = FLT_MAX;
+
+	//A body binned in a neighbouring cell may still reach this point, as long as it is no larger than a cell.
+	s32 cellX = point.X / cellSize;
+	s32 cellY = point.Y / cellSize;
+	for (s32 y = core::max_(cellY - 1, 0); y <= core::min_(cellY + 1, (s32)rows - 1); y++)
+	{
+		for (s32 x = core::max_(cellX - 1, 0); x <= core::min_(cellX + 1, (s32)columns - 1); x++)
+		{
+			u32 cell = y * columns + x;
+			for (u32 k = cellStart[cell]; k < cellStart[cell + 1]; k++)
+			{
+				test(point, cellBodies[k], nearest, nearestDepth);
+			}
+		}
+	}
+	for (u32 k = 0; k < oversized.size(); k++)
+	{
+		test(point, oversized[k], nearest, nearestDepth);
+	}
+
+	if (nearest >= 0)
+	{
+		return (*bodies)[nearest];
+	}
+	return pickTrail(point);
+}
+
+void BodyPicker::test(const position2di& point, u32 i, s32& nearest, f32& nearestDepth) const
+{
+	const Projected& p = projected[i];
+	f32 dx = point.X - p.x;
+	f32 dy = point.Y - p.y;
+	if (dx * dx + dy * dy <= p.radius * p.radius && p.depth < nearestDepth)
+	{
+		nearest = i;
+		nearestDepth = p.depth;
+	}
+}
+
+f32 BodyPicker::distanceToSegment(const position2di& point, const Projected& a, const Projected& b) const
+{
+	f32 sx = b.x - a.x;
+	f32 sy = b.y - a.y;
+	f32 lengthSQ = sx * sx + sy * sy;
+	f32 t = lengthSQ > 0 ? core::clamp(((point.X - a.x) * sx + (point.Y - a.y) * sy) / lengthSQ, 0.0f, 1.0f) : 0;
+	f32 dx = point.X - (a.x + sx * t);
+	f32 dy = point.Y - (a.y + sy * t);
+	return sqrtf(dx * dx + dy * dy);
+}
+
+//Trails are few and already decimated, so their segments are simply tested in turn.
+Body* BodyPicker::pickTrail(const position2di& point) const
+{
+	Body* nearest = 0;
+	f32 nearestDistance = minPixelRadius;
+
+	for (u32 i = 0; i < trailBodies.size(); i++)
+	{
+		Body* body = (*bodies)[trailBodies[i]];
+		const BodyVisual* visual = body->visual;
+		for (u32 node = 0; node < 2; node++)
+		{
+			scene::ISceneNode* sceneNode = node == 0 ? (scene::ISceneNode*)visual->orbitTrail : (scene::ISceneNode*)visual->orbitEllipse;
+			if (!sceneNode || !sceneNode->isVisible())
+			{
+				continue;
+			}
+
+			//The ellipse is closed, so its first point is visited again at the end.
+			u32 points = node == 0 ? visual->orbitTrail->size() : visual->orbitEllipse->size() + 1;
+			if (points < 2)
+			{
+				continue;
+			}
+
+			Projected previous;
+			bool previousValid = false;
+			for (u32 k = 0; k < points; k++)
+			{
+				vector3df position = node == 0 ? visual->orbitTrail->getPoint(k) : visual->orbitEllipse->getPoint(k % visual->orbitEllipse->size());
+				Projected current;
+				bool currentValid = project(position, current);
+				if (currentValid && previousValid)
+				{
+					f32 distance = distanceToSegment(point, previous, current);
+					if (distance < nearestDistance)
+					{
+						nearest = body;
+						nearestDistance = distance;
+					}
+				}
+				previous = current;
+				previousValid = currentValid;
+			}
+		}
+	}
+
+	return nearest;
+}
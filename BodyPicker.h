@@ -0,0 +1,51 @@
+#pragma once
+#include <irrlicht.h>
+#include "BodyVisual.h"
+#include "RenderFrame.h"
+using namespace irr;
+using namespace core;
+
+//Finds the body, or the body whose trail or orbit ellipse, is under a point on the screen.
+//Bodies are projected from their camera relative render positions and binned into a grid of screen cells,
+//so only those near the point are tested. Each counts as at least minPixelRadius across, so bodies
+//drawn as single points can still be picked, and among overlapping ones the nearest wins.
+class BodyPicker
+{
+public:
+	BodyPicker(u32 cellSize, f32 minPixelRadius);
+
+	//Projects and bins the bodies as seen from the camera, after which any number of points can be picked.
+	void build(const array<Body*>& bodies, const RenderFrame& frame, scene::ICameraSceneNode* camera, const dimension2d<u32>& screenSize);
+	Body* pick(const position2di& point) const;
+
+private:
+	struct Projected
+	{
+		f32 x;
+		f32 y;
+		f32 depth;
+		f32 radius; //In pixels.
+		u32 cell;
+	};
+
+	bool project(const vector3df& position, Projected& projected) const;
+	void test(const position2di& point, u32 i, s32& nearest, f32& nearestDepth) const;
+	Body* pickTrail(const position2di& point) const;
+	f32 distanceToSegment(const position2di& point, const Projected& a, const Projected& b) const;
+
+	u32 cellSize;
+	f32 minPixelRadius;
+
+	const array<Body*>* bodies;
+	matrix4 viewProjection;
+	dimension2d<u32> screenSize;
+	f32 pixelsPerUnit;
+	u32 columns;
+	u32 rows;
+
+	array<Projected> projected;
+	array<u32> cellStart; //Body indices sorted by cell are cellBodies[cellStart[cell]] up to cellStart[cell + 1].
+	array<u32> cellBodies;
+	array<u32> oversized; //Bodies larger than a cell, tested every time.
+	array<u32> trailBodies; //Bodies with a trail or orbit ellipse.
+};
@@ -0,0 +1,131 @@
+#include "BodyVisual.h"
+#include "SphereLod.h"
+#include "TextureLoader.h"
+
+BodyVisual::BodyVisual(Body* body,
+	double distanceScale,
+	u32 fixedPlanetDrawSize,
+	IrrlichtDevice *device,
+	TextureLoader* textures,
+	const SphereLod& lod
+	)
+{
+	this->body = body;
+	body->visual = this;
+	this->distanceScale = distanceScale;
+	orbitTrail = 0;
+	orbitEllipse = 0;
+	lodLevel = 0;
+	extent = 1;
+	if (fixedPlanetDrawSize == 0)
+	{
+		drawRadius = body->radius;
+	}
+	else
+	{
+		drawRadius = fixedPlanetDrawSize;
+	}
+
+	material.Lighting = false;
+	//With a loader the texture starts as a placeholder and is swapped in by the loader once decoded.
+	if (textures)
+	{
+		material.setTexture(0, textures->request(body->texturePath));
+	}
+	else
+	{
+		material.setTexture(0, device->getVideoDriver()->getTexture(body->texturePath));
+	}
+
+	//A shared unit sphere scaled to the draw radius, starting at the coarsest level until the first update picks one.
+	scene::ISceneManager* smgr = device->getSceneManager();
+	sphere = smgr->addMeshSceneNode(lod.getMesh(lodLevel), 0, 1, vector3df(body->position.X, body->position.Y, body->position.Z) * distanceScale, vector3df(0), vector3df(drawRadius));
+	sphere->getMaterial(0) = material;
+}
+
+BodyVisual::~BodyVisual()
+{
+	removeFromScene();
+	body->visual = 0;
+}
+
+void BodyVisual::prepareDraw(const RenderFrame& frame)
+{
+	if (!sphere)
+	{
+		return;
+	}
+
+	//Culling only ever hides nodes, so they are shown again here whenever the body is back in a replay.
+	sphere->setVisible(!body->removed);
+	if (orbitTrail)
+	{
+		orbitTrail->setVisible(!body->removed);
+	}
+	if (orbitEllipse)
+	{
+		orbitEllipse->setVisible(!body->removed);
+	}
+	if (body->removed)
+	{
+		return;
+	}
+
+	sphere->setPosition(frame.toRender(frame.drawPosition(body)));
+
+	if (orbitTrail)
+	{
+		orbitTrail->prepareDraw(frame);
+	}
+	if (orbitEllipse)
+	{
+		orbitEllipse->prepareDraw(frame);
+	}
+}
+
+void BodyVisual::setLodMesh(scene::IMesh* mesh, u32 level)
+{
+	//Swapping the mesh resets the node's materials to the mesh's, so the body's own material is restored.
+	sphere->setMesh(mesh);
+	sphere->getMaterial(0) = material;
+	lodLevel = level;
+}
+
+void BodyVisual::setTexture(u32 layer, video::ITexture* texture)
+{
+	material.setTexture(layer, texture);
+	if (sphere)
+	{
+		sphere->getMaterial(0).setTexture(layer, texture);
+	}
+}
+
+void BodyVisual::removeFromScene()
+{
+	if (orbitTrail)
+	{
+		orbitTrail->remove();
+		orbitTrail = 0;
+	}
+
+	if (orbitEllipse)
+	{
+		orbitEllipse->remove();
+		orbitEllipse = 0;
+	}
+
+	if (sphere)
+	{
+		sphere->remove();
+		sphere = 0;
+	}
+}
+
+void createBodyVisuals(const array<Body*>& bodies, u32 fixedPlanetDrawSize, double distanceScale, IrrlichtDevice *device, TextureLoader* textures, const SphereLod& lod)
+{
+	//Each visual attaches itself to its body, which holds it until it is deleted.
+	for (u32 i = 0; i < bodies.size(); i++)
+	{
+		new BodyVisual(bodies[i], distanceScale, fixedPlanetDrawSize, device, textures, lod);
+	}
+}
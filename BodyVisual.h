@@ -0,0 +1,42 @@
+#pragma once
+#include <irrlicht.h>
+#include "Body.h"
+#include "OrbitEllipseSceneNode.h"
+#include "OrbitTrailSceneNode.h"
+#include "RenderFrame.h"
+using namespace irr;
+using namespace core;
+
+class SphereLod;
+class TextureLoader;
+
+//Scene nodes of a body: its sphere and, once plotted, its trail or osculating orbit.
+//Attaches itself to the body on creation and detaches and removes its nodes when deleted.
+class BodyVisual
+{
+public:
+	BodyVisual(Body* body,
+		double distanceScale,
+		u32 fixedPlanetDrawSize,
+		IrrlichtDevice *device,
+		TextureLoader* textures,
+		const SphereLod& lod
+		);
+	~BodyVisual();
+	void prepareDraw(const RenderFrame& frame);
+	void setLodMesh(scene::IMesh* mesh, u32 level);
+	void setTexture(u32 layer, video::ITexture* texture);
+	void removeFromScene();
+
+	Body* body;
+	OrbitTrailSceneNode* orbitTrail;
+	OrbitEllipseSceneNode* orbitEllipse;
+	double distanceScale;
+	irr::scene::IMeshSceneNode* sphere;
+	double drawRadius;
+	f32 extent; //Reach of the sphere's children in sphere radii, so rings are not culled with the planet.
+	video::SMaterial material;
+	u32 lodLevel;
+};
+
+void createBodyVisuals(const array<Body*>&, u32, double, IrrlichtDevice*, TextureLoader*, const SphereLod&);
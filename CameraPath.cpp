@@ -0,0 +1,88 @@
+#include "CameraPath.h"
+
+array<CameraKey> createCameraPath()
+{
+	array<CameraKey> keys;
+
+	//From the starting overview down into the inner system, past the Earth and out to Jupiter, 1800 frames in all.
+	CameraKey overview;
+	overview.frame = 0;
+	overview.body = "Sol";
+	overview.position = vector3d<double>(0, 0, 5e5);
+	overview.target = vector3d<double>(0);
+	keys.push_back(overview);
+
+	CameraKey inner;
+	inner.frame = 500;
+	inner.body = "Sol";
+	inner.position = vector3d<double>(0, -4e4, 3e4);
+	inner.target = vector3d<double>(0);
+	keys.push_back(inner);
+
+	CameraKey earth;
+	earth.frame = 1000;
+	earth.body = "Earth";
+	earth.position = vector3d<double>(0, -8e3, 4e3);
+	earth.target = vector3d<double>(0);
+	keys.push_back(earth);
+
+	CameraKey jupiter;
+	jupiter.frame = 1800;
+	jupiter.body = "Jupiter";
+	jupiter.position = vector3d<double>(0, -1.5e4, 6e3);
+	jupiter.target = vector3d<double>(0);
+	keys.push_back(jupiter);
+
+	return keys;
+}
+
+CameraPath::CameraPath(const array<CameraKey>& keys)
+{
+	this->keys = keys;
+}
+
+vector3d<double> CameraPath::anchor(const CameraKey& key, const array<Body*>& bodies, const RenderFrame& renderFrame) const
+{
+	for (u32 i = 0; i < bodies.size(); i++)
+	{
+		if (bodies[i]->name == key.body)
+		{
+			return renderFrame.toScaled(renderFrame.drawPosition(bodies[i]));
+		}
+	}
+	return vector3d<double>(0);
+}
+
+void CameraPath::update(u32 frame, const array<Body*>& bodies, scene::ICameraSceneNode* camera, const RenderFrame& renderFrame) const
+{
+	if (keys.empty())
+	{
+		return;
+	}
+
+	u32 next = 0;
+	while (next < keys.size() && keys[next].frame <= frame)
+	{
+		next++;
+	}
+	const CameraKey& from = keys[next > 0 ? next - 1 : 0];
+	const CameraKey& to = keys[next < keys.size() ? next : keys.size() - 1];
+
+	//Smoothstep, so the camera comes to rest at each key instead of turning sharply.
+	double t = 0;
+	if (to.frame > from.frame)
+	{
+		t = (double)(frame - from.frame) / (to.frame - from.frame);
+		t = t * t * (3 - 2 * t);
+	}
+
+	//Both anchors are taken at this frame's time, so the camera stays with the bodies while it moves between them.
+	vector3d<double> fromAnchor = anchor(from, bodies, renderFrame);
+	vector3d<double> toAnchor = anchor(to, bodies, renderFrame);
+	vector3d<double> position = (fromAnchor + from.position) * (1 - t) + (toAnchor + to.position) * t;
+	vector3d<double> target = (fromAnchor + from.target) * (1 - t) + (toAnchor + to.target) * t;
+
+	camera->setPosition(renderFrame.scaledToRender(position));
+	camera->setTarget(renderFrame.scaledToRender(target));
+	camera->updateAbsolutePosition();
+}
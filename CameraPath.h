@@ -0,0 +1,34 @@
+#pragma once
+#include <irrlicht.h>
+#include "Body.h"
+#include "RenderFrame.h"
+using namespace irr;
+using namespace core;
+
+//Where the camera is at one frame of a scripted flight. Position and target are in draw units relative to the
+//scaled position of the named body, or to the Sun if no body of that name exists.
+struct CameraKey
+{
+	u32 frame;
+	stringw body;
+	vector3d<double> position;
+	vector3d<double> target;
+};
+
+array<CameraKey> createCameraPath();
+
+//Flies the camera through keys sorted by frame, easing in and out of each one. Between two keys the camera moves
+//from one body's neighbourhood to the other's, so a flight can hand over from planet to planet while both orbit.
+class CameraPath
+{
+public:
+	CameraPath(const array<CameraKey>& keys);
+
+	//Call once per frame after the frame's interpolation is set. Frames past the last key hold it.
+	void update(u32 frame, const array<Body*>& bodies, scene::ICameraSceneNode* camera, const RenderFrame& renderFrame) const;
+
+private:
+	vector3d<double> anchor(const CameraKey& key, const array<Body*>& bodies, const RenderFrame& renderFrame) const;
+
+	array<CameraKey> keys;
+};
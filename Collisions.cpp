@@ -0,0 +1,212 @@
+#include "Collisions.h"
+#include <cmath>
+
+struct CellEntry
+{
+	s64 x, y, z;
+	u64 key;
+	u32 body;
+
+	bool operator<(const CellEntry& other) const
+	{
+		return key < other.key || (key == other.key && body < other.body);
+	}
+};
+
+static s64 cellCoordinate(double value, double cellSize)
+{
+	return (s64)floor(value / cellSize);
+}
+
+static u64 cellKey(s64 x, s64 y, s64 z)
+{
+	return ((u64)x * 73856093ULL) ^ ((u64)y * 19349663ULL) ^ ((u64)z * 83492791ULL);
+}
+
+static bool sweptSpheresTouch(const vector3d<double>& startOffset, const vector3d<double>& endOffset, double distance, double& time)
+{
+	vector3d<double> motion = endOffset - startOffset;
+	double c = startOffset.getLengthSQ() - distance * distance;
+	if (c <= 0)
+	{
+		time = 0;
+		return true;
+	}
+
+	double a = motion.getLengthSQ();
+	double b = 2 * startOffset.dotProduct(motion);
+	double discriminant = b * b - 4 * a * c;
+	if (a == 0 || discriminant < 0)
+	{
+		return false;
+	}
+
+	time = (-b - sqrt(discriminant)) / (2 * a);
+	return time >= 0 && time <= 1;
+}
+
+void detectCollisions(const array<Body*>& bodies, const array<vector3d<double> >& previousPositions, array<Collision>& collisions)
+{
+	collisions.set_used(0);
+	if (bodies.size() < 2)
+	{
+		return;
+	}
+
+	array<aabbox3d<double> > sweptBoxes;
+	sweptBoxes.reallocate(bodies.size());
+	double cellSize = 0;
+	for (u32 i = 0; i < bodies.size(); i++)
+	{
+		aabbox3d<double> box(previousPositions[i]);
+		box.addInternalPoint(bodies[i]->position);
+		box.MinEdge -= vector3d<double>(bodies[i]->radius);
+		box.MaxEdge += vector3d<double>(bodies[i]->radius);
+		sweptBoxes.push_back(box);
+
+		vector3d<double> extent = box.getExtent();
+		cellSize = core::max_(cellSize, extent.X, core::max_(extent.Y, extent.Z));
+	}
+
+	if (cellSize <= 0)
+	{
+		return;
+	}
+
+	//Cells are at least as large as the largest swept box, so every box touches at most eight cells.
+	array<CellEntry> entries;
+	entries.reallocate(bodies.size() * 8);
+	for (u32 i = 0; i < bodies.size(); i++)
+	{
+		const aabbox3d<double>& box = sweptBoxes[i];
+		for (s64 x = cellCoordinate(box.MinEdge.X, cellSize); x <= cellCoordinate(box.MaxEdge.X, cellSize); x++)
+		{
+			for (s64 y = cellCoordinate(box.MinEdge.Y, cellSize); y <= cellCoordinate(box.MaxEdge.Y, cellSize); y++)
+			{
+				for (s64 z = cellCoordinate(box.MinEdge.Z, cellSize); z <= cellCoordinate(box.MaxEdge.Z, cellSize); z++)
+				{
+					CellEntry entry;
+					entry.x = x;
+					entry.y = y;
+					entry.z = z;
+					entry.key = cellKey(x, y, z);
+					entry.body = i;
+					entries.push_back(entry);
+				}
+			}
+		}
+	}
+	entries.sort();
+
+	for (u32 start = 0; start < entries.size();)
+	{
+		u32 end = start + 1;
+		while (end < entries.size() && entries[end].key == entries[start].key)
+		{
+			end++;
+		}
+
+		for (u32 i = start; i < end; i++)
+		{
+			for (u32 j = i + 1; j < end; j++)
+			{
+				const CellEntry& a = entries[i];
+				const CellEntry& b = entries[j];
+				if (a.x != b.x || a.y != b.y || a.z != b.z || a.body == b.body)
+				{
+					continue;
+				}
+
+				const aabbox3d<double>& boxA = sweptBoxes[a.body];
+				const aabbox3d<double>& boxB = sweptBoxes[b.body];
+				if (!boxA.intersectsWithBox(boxB))
+				{
+					continue;
+				}
+
+				//Pairs sharing several cells are only tested in the cell holding the corner of their overlap.
+				vector3d<double> overlapCorner(
+					core::max_(boxA.MinEdge.X, boxB.MinEdge.X),
+					core::max_(boxA.MinEdge.Y, boxB.MinEdge.Y),
+					core::max_(boxA.MinEdge.Z, boxB.MinEdge.Z));
+				if (cellCoordinate(overlapCorner.X, cellSize) != a.x ||
+					cellCoordinate(overlapCorner.Y, cellSize) != a.y ||
+					cellCoordinate(overlapCorner.Z, cellSize) != a.z)
+				{
+					continue;
+				}
+
+				Collision collision;
+				collision.first = core::min_(a.body, b.body);
+				collision.second = core::max_(a.body, b.body);
+				vector3d<double> startOffset = previousPositions[collision.second] - previousPositions[collision.first];
+				vector3d<double> endOffset = bodies[collision.second]->position - bodies[collision.first]->position;
+				if (sweptSpheresTouch(startOffset, endOffset, bodies[a.body]->radius + bodies[b.body]->radius, collision.time))
+				{
+					collisions.push_back(collision);
+				}
+			}
+		}
+
+		start = end;
+	}
+}
+
+void resolveCollisions(array<Body*>& bodies, array<Collision>& collisions, int response, array<Body*>& removed)
+{
+	collisions.sort();
+
+	array<bool> gone;
+	gone.set_used(bodies.size());
+	for (u32 i = 0; i < bodies.size(); i++)
+	{
+		gone[i] = false;
+	}
+
+	for (u32 i = 0; i < collisions.size(); i++)
+	{
+		u32 first = collisions[i].first;
+		u32 second = collisions[i].second;
+		if (gone[first] || gone[second])
+		{
+			continue;
+		}
+
+		//The heavier body survives. Ties go to the lower index, which keeps the Sun at index 0.
+		u32 survivor = bodies[second]->mass > bodies[first]->mass ? second : first;
+		u32 victim = survivor == first ? second : first;
+		Body* kept = bodies[survivor];
+		Body* lost = bodies[victim];
+
+		if (response == COLLISION_MERGE)
+		{
+			double mass = kept->mass + lost->mass;
+
+			//The Sun is held fixed at the origin, so it only gains mass.
+			if (survivor != 0)
+			{
+				kept->position = (kept->position * kept->mass + lost->position * lost->mass) / mass;
+				kept->velocity = (kept->velocity * kept->mass + lost->velocity * lost->mass) / mass;
+			}
+
+			kept->radius = pow(pow(kept->radius, 3) + pow(lost->radius, 3), 1.0 / 3.0);
+			kept->mass = mass;
+		}
+
+		gone[victim] = true;
+	}
+
+	u32 kept = 0;
+	for (u32 i = 0; i < bodies.size(); i++)
+	{
+		if (gone[i])
+		{
+			removed.push_back(bodies[i]);
+		}
+		else
+		{
+			bodies[kept++] = bodies[i];
+		}
+	}
+	bodies.set_used(kept);
+}
@@ -0,0 +1,26 @@
+#pragma once
+#include "Body.h"
+using namespace irr;
+using namespace core;
+
+enum CollisionResponse { COLLISION_MERGE, COLLISION_REMOVE };
+
+struct Collision
+{
+	u32 first;
+	u32 second;
+	double time; //Fraction of the last step at which the spheres first touched.
+
+	bool operator<(const Collision& other) const
+	{
+		return time < other.time;
+	}
+};
+
+//Finds every pair of bodies whose spheres touched during the last step, assuming straight-line motion
+//from previousPositions. Candidate pairs come from a spatial hash over the swept bounding boxes.
+void detectCollisions(const array<Body*>& bodies, const array<vector3d<double> >& previousPositions, array<Collision>& collisions);
+
+//Applies the collisions in time order. Bodies that no longer take part are taken out of bodies and
+//handed back in removed, the caller owns them.
+void resolveCollisions(array<Body*>& bodies, array<Collision>& collisions, int response, array<Body*>& removed);
@@ -0,0 +1,10 @@
+#pragma once
+//The simulation core only uses Irrlicht's header only math and container templates, never irrlicht.h,
+//so it builds and links without the engine library and runs on machines without a graphics stack.
+#include <aabbox3d.h>
+#include <irrArray.h>
+#include <irrMath.h>
+#include <irrString.h>
+#include <irrTypes.h>
+#include <path.h>
+#include <vector3d.h>
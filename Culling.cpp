@@ -0,0 +1,112 @@
+#include "Culling.h"
+#include <cmath>
+
+//Frustum plane normals point outwards, so anything further than its radius in front of a plane is outside.
+bool sphereOutside(const scene::SViewFrustum& frustum, const vector3df& center, f32 radius)
+{
+	for (u32 i = 0; i < scene::SViewFrustum::VF_PLANE_COUNT; i++)
+	{
+		if (frustum.planes[i].getDistanceTo(center) > radius)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+//A box is outside if its corner furthest behind some plane is still in front of it.
+bool boxOutside(const scene::SViewFrustum& frustum, const aabbox3df& box)
+{
+	for (u32 i = 0; i < scene::SViewFrustum::VF_PLANE_COUNT; i++)
+	{
+		const vector3df& normal = frustum.planes[i].Normal;
+		vector3df corner(normal.X < 0 ? box.MaxEdge.X : box.MinEdge.X,
+			normal.Y < 0 ? box.MaxEdge.Y : box.MinEdge.Y,
+			normal.Z < 0 ? box.MaxEdge.Z : box.MinEdge.Z);
+		if (frustum.planes[i].getDistanceTo(corner) > 0)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+static bool cullNode(scene::ISceneNode* node, const scene::SViewFrustum& frustum, const vector3df& cameraPosition, f32 pixelsPerUnit, f32 minPixelSize, CullStats& stats)
+{
+	//Trail and ellipse nodes are only ever translated, so their box just moves with the node.
+	aabbox3df box = node->getBoundingBox();
+	box.MinEdge += node->getPosition();
+	box.MaxEdge += node->getPosition();
+
+	bool visible = !boxOutside(frustum, box);
+	if (visible && !box.isPointInside(cameraPosition))
+	{
+		vector3df closest(core::clamp(cameraPosition.X, box.MinEdge.X, box.MaxEdge.X),
+			core::clamp(cameraPosition.Y, box.MinEdge.Y, box.MaxEdge.Y),
+			core::clamp(cameraPosition.Z, box.MinEdge.Z, box.MaxEdge.Z));
+		f32 distance = core::max_(closest.getDistanceFrom(cameraPosition), 1e-3f);
+		visible = box.getExtent().getLength() / distance * pixelsPerUnit >= minPixelSize;
+	}
+
+	node->setVisible(visible);
+	if (visible)
+	{
+		stats.trailsDrawn++;
+	}
+	else
+	{
+		stats.trailsCulled++;
+	}
+	return visible;
+}
+
+void cullBodies(const array<Body*>& bodies, scene::ICameraSceneNode* camera, u32 screenHeight, f32 minPixelSize, CullStats& stats)
+{
+	stats.bodiesDrawn = 0;
+	stats.bodiesCulled = 0;
+	stats.trailsDrawn = 0;
+	stats.trailsCulled = 0;
+
+	vector3df cameraPosition = camera->getAbsolutePosition();
+	matrix4 view;
+	view.buildCameraLookAtMatrixLH(cameraPosition, camera->getTarget(), camera->getUpVector());
+	scene::SViewFrustum frustum(camera->getProjectionMatrix() * view);
+
+	f32 pixelsPerUnit = screenHeight * 0.5f / tanf(camera->getFOV() * 0.5f);
+
+	for (u32 i = 0; i < bodies.size(); i++)
+	{
+		BodyVisual* visual = bodies[i]->visual;
+		if (!visual || bodies[i]->removed)
+		{
+			continue;
+		}
+
+		if (visual->sphere)
+		{
+			vector3df center = visual->sphere->getPosition();
+			f32 radius = (f32)visual->drawRadius * visual->extent;
+			f32 distance = core::max_(center.getDistanceFrom(cameraPosition), 1e-3f);
+
+			bool visible = !sphereOutside(frustum, center, radius) && 2 * radius / distance * pixelsPerUnit >= minPixelSize;
+			visual->sphere->setVisible(visible);
+			if (visible)
+			{
+				stats.bodiesDrawn++;
+			}
+			else
+			{
+				stats.bodiesCulled++;
+			}
+		}
+
+		if (visual->orbitTrail && visual->orbitTrail->size() > 1)
+		{
+			cullNode(visual->orbitTrail, frustum, cameraPosition, pixelsPerUnit, minPixelSize, stats);
+		}
+		if (visual->orbitEllipse)
+		{
+			cullNode(visual->orbitEllipse, frustum, cameraPosition, pixelsPerUnit, minPixelSize, stats);
+		}
+	}
+}
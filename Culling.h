@@ -0,0 +1,22 @@
+#pragma once
+#include <irrlicht.h>
+#include "BodyVisual.h"
+using namespace irr;
+using namespace core;
+
+//Frustum tests, also used by nodes that cull their own contents.
+bool sphereOutside(const scene::SViewFrustum& frustum, const vector3df& center, f32 radius);
+bool boxOutside(const scene::SViewFrustum& frustum, const aabbox3df& box);
+
+struct CullStats
+{
+	u32 bodiesDrawn;
+	u32 bodiesCulled;
+	u32 trailsDrawn;
+	u32 trailsCulled;
+};
+
+//Hides body spheres, trails and orbit ellipses that are outside the camera frustum or smaller on screen than
+//minPixelSize, in one pass over the bodies before the scene manager sees them. Positions must already be
+//prepared for this frame, so the frustum is built from the camera directly rather than taken from last frame's.
+void cullBodies(const array<Body*>& bodies, scene::ICameraSceneNode* camera, u32 screenHeight, f32 minPixelSize, CullStats& stats);
@@ -0,0 +1,209 @@
+#include "EncounterMonitor.h"
+#include "Simulation.h"
+#include <cmath>
+
+EncounterMonitor::EncounterMonitor(const io::path& logFile, double hillRadii)
+{
+	this->hillRadii = hillRadii;
+	stopping = false;
+
+	log = fopen(logFile.c_str(), "w");
+	if (log)
+	{
+		fprintf(log, "body,other,start_time,closest_time,min_distance,relative_speed,threshold\n");
+		writer = std::thread(&EncounterMonitor::writeLog, this);
+	}
+}
+
+EncounterMonitor::~EncounterMonitor()
+{
+	//Encounters still in progress are logged with what has been seen so far.
+	for (std::map<BodyPair, Encounter>::iterator it = active.begin(); it != active.end(); ++it)
+	{
+		finish(it->second);
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(queueLock);
+		stopping = true;
+	}
+	queueChanged.notify_one();
+
+	if (writer.joinable())
+	{
+		writer.join();
+	}
+
+	if (log)
+	{
+		fclose(log);
+	}
+}
+
+void EncounterMonitor::update(const array<Body*>& bodies, double time, double timeStep)
+{
+	if (bodies.empty())
+	{
+		return;
+	}
+
+	//Hill radius around the Sun, approximating the semi-major axis by the current distance.
+	double sunMass = bodies[0]->mass;
+	thresholds.set_used(bodies.size());
+	for (u32 i = 1; i < bodies.size(); i++)
+	{
+		thresholds[i] = hillRadii * bodies[i]->position.getLength() * pow(bodies[i]->mass / (3 * sunMass), 1.0 / 3.0);
+	}
+
+	//The order barely changes between updates, so the intervals are kept and insertion sorted.
+	if (intervals.size() != bodies.size() - 1)
+	{
+		intervals.set_used(bodies.size() - 1);
+		for (u32 i = 1; i < bodies.size(); i++)
+		{
+			intervals[i - 1].body = i;
+		}
+	}
+
+	//Each interval covers the body's path over the coming step, so pairs that only close in between samples are still found.
+	for (u32 i = 0; i < intervals.size(); i++)
+	{
+		Interval& interval = intervals[i];
+		const Body* body = bodies[interval.body];
+		double x = body->position.X;
+		double end = x + body->velocity.X * timeStep;
+		interval.min = core::min_(x, end) - thresholds[interval.body];
+		interval.max = core::max_(x, end) + thresholds[interval.body];
+	}
+
+	for (u32 i = 1; i < intervals.size(); i++)
+	{
+		Interval interval = intervals[i];
+		u32 j = i;
+		while (j > 0 && intervals[j - 1].min > interval.min)
+		{
+			intervals[j] = intervals[j - 1];
+			j--;
+		}
+		intervals[j] = interval;
+	}
+
+	stillActive.clear();
+	for (u32 i = 0; i < intervals.size(); i++)
+	{
+		for (u32 j = i + 1; j < intervals.size() && intervals[j].min <= intervals[i].max; j++)
+		{
+			const Body* a = bodies[core::min_(intervals[i].body, intervals[j].body)];
+			const Body* b = bodies[core::max_(intervals[i].body, intervals[j].body)];
+			double threshold = core::max_(thresholds[intervals[i].body], thresholds[intervals[j].body]);
+
+			//Closest approach within the coming step, assuming straight-line relative motion.
+			vector3d<double> offset = b->position - a->position;
+			vector3d<double> relativeVelocity = b->velocity - a->velocity;
+			double speedSquared = relativeVelocity.getLengthSQ();
+			double closestTime = 0;
+			if (speedSquared > 0)
+			{
+				closestTime = core::clamp(-offset.dotProduct(relativeVelocity) / speedSquared, 0.0, timeStep);
+			}
+			double distance = (offset + relativeVelocity * closestTime).getLength();
+
+			if (distance > threshold)
+			{
+				continue;
+			}
+
+			BodyPair pair(a, b);
+			std::map<BodyPair, Encounter>::iterator it = active.find(pair);
+			Encounter encounter;
+			if (it != active.end())
+			{
+				encounter = it->second;
+			}
+			else
+			{
+				encounter.body = a->name;
+				encounter.other = b->name;
+				encounter.startTime = time;
+				encounter.minDistance = 1e300;
+				encounter.threshold = threshold;
+			}
+
+			if (distance < encounter.minDistance)
+			{
+				encounter.closestTime = time + closestTime;
+				encounter.minDistance = distance;
+				encounter.relativeSpeed = sqrt(speedSquared);
+			}
+
+			stillActive[pair] = encounter;
+		}
+	}
+
+	for (std::map<BodyPair, Encounter>::iterator it = active.begin(); it != active.end(); ++it)
+	{
+		if (stillActive.find(it->first) == stillActive.end())
+		{
+			finish(it->second);
+		}
+	}
+	active.swap(stillActive);
+}
+
+void EncounterMonitor::bodyRemoved(const Body* body)
+{
+	std::map<BodyPair, Encounter>::iterator it = active.begin();
+	while (it != active.end())
+	{
+		if (it->first.first == body || it->first.second == body)
+		{
+			finish(it->second);
+			active.erase(it++);
+		}
+		else
+		{
+			++it;
+		}
+	}
+}
+
+void EncounterMonitor::finish(const Encounter& encounter)
+{
+	if (!log)
+	{
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(queueLock);
+		queue.push_back(encounter);
+	}
+	queueChanged.notify_one();
+}
+
+void EncounterMonitor::writeLog()
+{
+	std::unique_lock<std::mutex> lock(queueLock);
+	while (true)
+	{
+		queueChanged.wait(lock, [this]() { return stopping || !queue.empty(); });
+
+		while (!queue.empty())
+		{
+			Encounter encounter = queue.front();
+			queue.pop_front();
+
+			lock.unlock();
+			fprintf(log, "%s,%s,%.1f,%.1f,%.9e,%.9e,%.9e\n",
+				encounter.body.c_str(), encounter.other.c_str(), encounter.startTime, encounter.closestTime,
+				encounter.minDistance, encounter.relativeSpeed, encounter.threshold);
+			fflush(log);
+			lock.lock();
+		}
+
+		if (stopping)
+		{
+			return;
+		}
+	}
+}
@@ -0,0 +1,61 @@
+#pragma once
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <thread>
+#include "Body.h"
+using namespace irr;
+using namespace core;
+
+struct Encounter
+{
+	stringc body;
+	stringc other;
+	double startTime;
+	double closestTime;
+	double minDistance;
+	double relativeSpeed; //At closest approach.
+	double threshold;
+};
+
+//Flags pairs of planets closer than a multiple of the larger Hill radius and logs each encounter once it is over.
+//Candidate pairs come from sweep and prune along X, the log is written by a background thread.
+class EncounterMonitor
+{
+public:
+	EncounterMonitor(const io::path& logFile, double hillRadii);
+	~EncounterMonitor();
+
+	void update(const array<Body*>& bodies, double time, double timeStep);
+
+	//Logs and forgets the encounters of a body before it is deleted, so no pair outlives it.
+	void bodyRemoved(const Body* body);
+
+private:
+	typedef std::pair<const Body*, const Body*> BodyPair;
+
+	struct Interval
+	{
+		double min;
+		double max;
+		u32 body;
+	};
+
+	void finish(const Encounter& encounter);
+	void writeLog();
+
+	double hillRadii;
+	array<Interval> intervals;
+	array<double> thresholds;
+	std::map<BodyPair, Encounter> active;
+	std::map<BodyPair, Encounter> stillActive;
+
+	FILE* log;
+	std::thread writer;
+	std::mutex queueLock;
+	std::condition_variable queueChanged;
+	std::deque<Encounter> queue;
+	bool stopping;
+};
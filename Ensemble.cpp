@@ -0,0 +1,292 @@
+#include "Ensemble.h"
+#include "BatchedSystems.h"
+#include "Simulation.h"
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+
+//Per-worker run queues. Owners take from the back, idle workers steal from the front of someone else's queue.
+class WorkStealingQueues
+{
+public:
+	WorkStealingQueues(u32 nrOfWorkers) : queues(nrOfWorkers), locks(nrOfWorkers)
+	{
+	}
+
+	void push(u32 worker, u32 task)
+	{
+		std::lock_guard<std::mutex> lock(locks[worker]);
+		queues[worker].push_back(task);
+	}
+
+	bool pop(u32 worker, u32& task)
+	{
+		{
+			std::lock_guard<std::mutex> lock(locks[worker]);
+			if (!queues[worker].empty())
+			{
+				task = queues[worker].back();
+				queues[worker].pop_back();
+				return true;
+			}
+		}
+
+		for (u32 i = 1; i < queues.size(); i++)
+		{
+			u32 victim = (worker + i) % queues.size();
+			std::lock_guard<std::mutex> lock(locks[victim]);
+			if (!queues[victim].empty())
+			{
+				task = queues[victim].front();
+				queues[victim].pop_front();
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+private:
+	std::vector<std::deque<u32> > queues;
+	std::vector<std::mutex> locks;
+};
+
+array<EnsembleRun> createParameterSweep(u32 nrOfRuns, const array<double>& timeSteps, const array<int>& integrationMethods, double positionPerturbation, double velocityPerturbation, u32 seed)
+{
+	array<EnsembleRun> runs;
+	runs.reallocate(nrOfRuns);
+
+	for (u32 i = 0; i < nrOfRuns; i++)
+	{
+		EnsembleRun run;
+		run.id = i;
+		run.seed = seed + i;
+		run.integrationMethod = integrationMethods[i % integrationMethods.size()];
+		run.timeStep = timeSteps[(i / integrationMethods.size()) % timeSteps.size()];
+		run.positionPerturbation = positionPerturbation;
+		run.velocityPerturbation = velocityPerturbation;
+		runs.push_back(run);
+	}
+
+	return runs;
+}
+
+double totalEnergy(const array<Body>& bodies)
+{
+	//The Sun is fixed at the origin, so only the planets carry kinetic energy.
+	double energy = 0;
+	for (u32 i = 1; i < bodies.size(); i++)
+	{
+		energy += 0.5 * bodies[i].mass * bodies[i].velocity.getLengthSQ();
+		energy -= G * bodies[0].mass * bodies[i].mass / bodies[i].position.getLength();
+	}
+	return energy;
+}
+
+static void createEnsembleMember(const array<Body*>& initialBodies, const EnsembleRun& run, array<Body>& bodies)
+{
+	std::mt19937 generator(run.seed);
+	std::normal_distribution<double> noise(0, 1);
+
+	bodies.reallocate(initialBodies.size());
+	for (u32 i = 0; i < initialBodies.size(); i++)
+	{
+		bodies.push_back(*initialBodies[i]);
+		if (i > 0)
+		{
+			Body& body = bodies.getLast();
+			body.position += vector3d<double>(noise(generator), noise(generator), noise(generator)) * body.position.getLength() * run.positionPerturbation;
+			body.velocity += vector3d<double>(noise(generator), noise(generator), noise(generator)) * body.velocity.getLength() * run.velocityPerturbation;
+		}
+	}
+}
+
+void runEnsembleMember(const array<Body*>& initialBodies, const EnsembleRun& run, double duration, EnsembleResult& result)
+{
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	array<Body> bodies;
+	createEnsembleMember(initialBodies, run, bodies);
+
+	result.id = run.id;
+	result.initialEnergy = totalEnergy(bodies);
+	result.maxRelativeEnergyError = 0;
+	result.minSunDistance = 1e300;
+	result.maxSunDistance = 0;
+	result.steps = (u64)(duration / run.timeStep);
+
+	for (u64 step = 0; step < result.steps; step++)
+	{
+		for (u32 i = 1; i < bodies.size(); i++)
+		{
+			integrate(&bodies[0], &bodies[i], run.timeStep, run.integrationMethod);
+
+			double distance = bodies[i].position.getLength();
+			result.minSunDistance = core::min_(result.minSunDistance, distance);
+			result.maxSunDistance = core::max_(result.maxSunDistance, distance);
+		}
+
+		double relativeEnergyError = fabs((totalEnergy(bodies) - result.initialEnergy) / result.initialEnergy);
+		result.maxRelativeEnergyError = core::max_(result.maxRelativeEnergyError, relativeEnergyError);
+	}
+
+	result.finalEnergy = totalEnergy(bodies);
+	result.wallTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+void runEnsembleBatch(const array<Body*>& initialBodies, const array<EnsembleRun>& runs, const array<u32>& batch, double duration, array<EnsembleResult>& results)
+{
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	BatchedSystems systems(initialBodies.size(), batch.size());
+	for (u32 s = 0; s < batch.size(); s++)
+	{
+		array<Body> bodies;
+		createEnsembleMember(initialBodies, runs[batch[s]], bodies);
+		systems.setSystem(s, bodies);
+
+		EnsembleResult& result = results[batch[s]];
+		result.id = runs[batch[s]].id;
+		result.initialEnergy = systems.energy(s);
+		result.maxRelativeEnergyError = 0;
+		result.minSunDistance = 1e300;
+		result.maxSunDistance = 0;
+		result.steps = (u64)(duration / runs[batch[s]].timeStep);
+	}
+
+	//Every run in a batch shares the time step, so they all take the same number of steps.
+	double timeStep = runs[batch[0]].timeStep;
+	u64 steps = results[batch[0]].steps;
+
+	for (u64 step = 0; step < steps; step++)
+	{
+		systems.step(timeStep);
+
+		for (u32 s = 0; s < batch.size(); s++)
+		{
+			EnsembleResult& result = results[batch[s]];
+			for (u32 b = 1; b < systems.nrOfBodies; b++)
+			{
+				double distance = systems.sunDistance(s, b);
+				result.minSunDistance = core::min_(result.minSunDistance, distance);
+				result.maxSunDistance = core::max_(result.maxSunDistance, distance);
+			}
+
+			double relativeEnergyError = fabs((systems.energy(s) - result.initialEnergy) / result.initialEnergy);
+			result.maxRelativeEnergyError = core::max_(result.maxRelativeEnergyError, relativeEnergyError);
+		}
+	}
+
+	double wallTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	for (u32 s = 0; s < batch.size(); s++)
+	{
+		results[batch[s]].finalEnergy = systems.energy(s);
+		results[batch[s]].wallTime = wallTime / batch.size();
+	}
+}
+
+int runEnsemble(const array<EnsembleRun>& runs, double duration, const io::path& outputFile, u32 threadCount, bool useBatchedKernel)
+{
+	//Initial conditions are created once and only read by the workers.
+	array<Body*> initialBodies = createBodies();
+
+	if (threadCount == 0)
+	{
+		threadCount = std::thread::hardware_concurrency();
+	}
+	threadCount = core::max_<u32>(threadCount, 1);
+
+	//A task is a group of runs. Leapfrog runs sharing a time step are packed into lanes of the batched kernel,
+	//everything else runs on its own.
+	array<array<u32> > tasks;
+	for (u32 i = 0; i < runs.size(); i++)
+	{
+		bool batched = false;
+		if (useBatchedKernel && runs[i].integrationMethod == LEAPFROG)
+		{
+			for (u32 t = 0; t < tasks.size(); t++)
+			{
+				const EnsembleRun& first = runs[tasks[t][0]];
+				if (first.integrationMethod == LEAPFROG && first.timeStep == runs[i].timeStep && tasks[t].size() < BATCH_LANES)
+				{
+					tasks[t].push_back(i);
+					batched = true;
+					break;
+				}
+			}
+		}
+
+		if (!batched)
+		{
+			tasks.push_back(array<u32>());
+			tasks.getLast().push_back(i);
+		}
+	}
+
+	WorkStealingQueues queues(threadCount);
+	for (u32 i = 0; i < tasks.size(); i++)
+	{
+		queues.push(i % threadCount, i);
+	}
+
+	array<EnsembleResult> results;
+	results.set_used(runs.size());
+
+	std::vector<std::thread> workers;
+	for (u32 t = 0; t < threadCount; t++)
+	{
+		workers.push_back(std::thread([&, t]()
+		{
+			u32 task;
+			while (queues.pop(t, task))
+			{
+				const array<u32>& batch = tasks[task];
+				if (useBatchedKernel && runs[batch[0]].integrationMethod == LEAPFROG)
+				{
+					runEnsembleBatch(initialBodies, runs, batch, duration, results);
+				}
+				else
+				{
+					runEnsembleMember(initialBodies, runs[batch[0]], duration, results[batch[0]]);
+				}
+			}
+		}));
+	}
+
+	for (u32 t = 0; t < workers.size(); t++)
+	{
+		workers[t].join();
+	}
+
+	for (u32 i = 0; i < initialBodies.size(); i++)
+	{
+		delete initialBodies[i];
+	}
+
+	FILE* output = fopen(outputFile.c_str(), "w");
+	if (!output)
+	{
+		printf("Could not write ensemble results %s\n", outputFile.c_str());
+		return 1;
+	}
+
+	fprintf(output, "run,seed,time_step,integration_method,position_perturbation,velocity_perturbation,steps,initial_energy,final_energy,max_relative_energy_error,min_sun_distance,max_sun_distance,wall_time\n");
+	for (u32 i = 0; i < runs.size(); i++)
+	{
+		const EnsembleRun& run = runs[i];
+		const EnsembleResult& result = results[i];
+		fprintf(output, "%u,%u,%.3f,%d,%.6e,%.6e,%llu,%.9e,%.9e,%.9e,%.9e,%.9e,%.6f\n",
+			run.id, run.seed, run.timeStep, run.integrationMethod, run.positionPerturbation, run.velocityPerturbation,
+			(unsigned long long)result.steps, result.initialEnergy, result.finalEnergy, result.maxRelativeEnergyError,
+			result.minSunDistance, result.maxSunDistance, result.wallTime);
+	}
+
+	fclose(output);
+	return 0;
+}
@@ -0,0 +1,33 @@
+#pragma once
+#include "Body.h"
+using namespace irr;
+using namespace core;
+
+//One independent variant of the createBodies() system.
+struct EnsembleRun
+{
+	u32 id;
+	u32 seed;
+	double timeStep;
+	int integrationMethod;
+	double positionPerturbation; //Relative size of the random offset applied to every planet position.
+	double velocityPerturbation; //Relative size of the random offset applied to every planet velocity.
+};
+
+struct EnsembleResult
+{
+	u32 id;
+	u64 steps;
+	double initialEnergy;
+	double finalEnergy;
+	double maxRelativeEnergyError;
+	double minSunDistance;
+	double maxSunDistance;
+	double wallTime;
+};
+
+array<EnsembleRun> createParameterSweep(u32 nrOfRuns, const array<double>& timeSteps, const array<int>& integrationMethods, double positionPerturbation, double velocityPerturbation, u32 seed);
+double totalEnergy(const array<Body>& bodies);
+void runEnsembleMember(const array<Body*>& initialBodies, const EnsembleRun& run, double duration, EnsembleResult& result);
+void runEnsembleBatch(const array<Body*>& initialBodies, const array<EnsembleRun>& runs, const array<u32>& batch, double duration, array<EnsembleResult>& results);
+int runEnsemble(const array<EnsembleRun>& runs, double duration, const io::path& outputFile, u32 threadCount, bool useBatchedKernel);
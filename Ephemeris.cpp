@@ -0,0 +1,184 @@
+#include "Ephemeris.h"
+#include "Simulation.h"
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+bool loadEphemeris(const io::path& fileName, array<EphemerisPoint>& points)
+{
+	FILE* file = fopen(fileName.c_str(), "r");
+	if (!file)
+	{
+		return false;
+	}
+
+	char line[512];
+	while (fgets(line, sizeof(line), file))
+	{
+		for (char* c = line; *c; c++)
+		{
+			if (*c == ',')
+			{
+				*c = ' ';
+			}
+		}
+
+		const char* start = line;
+		while (*start == ' ' || *start == '\t')
+		{
+			start++;
+		}
+
+		if (*start == '#')
+		{
+			continue;
+		}
+
+		EphemerisPoint point;
+		if (sscanf(start, "%lf %lf %lf %lf", &point.time, &point.position.X, &point.position.Y, &point.position.Z) == 4)
+		{
+			points.push_back(point);
+		}
+	}
+
+	fclose(file);
+	points.sort();
+	return true;
+}
+
+void compareWithEphemeris(const Body* sun, const Body* body, const array<EphemerisPoint>& reference, double timeStep, int integrationMethod, array<EphemerisError>& errors)
+{
+	Body central(*sun);
+	Body state(*body);
+	u64 steps = 0;
+
+	for (u32 i = 0; i < reference.size(); i++)
+	{
+		const EphemerisPoint& point = reference[i];
+		if (point.time < 0)
+		{
+			continue;
+		}
+
+		while ((steps + 1) * timeStep <= point.time)
+		{
+			integrate(&central, &state, timeStep, integrationMethod);
+			steps++;
+		}
+
+		//Finish with a partial step on a copy so the main trajectory stays on the regular time grid.
+		Body probe(state);
+		double remainder = point.time - steps * timeStep;
+		if (remainder > 0)
+		{
+			integrate(&central, &probe, remainder, integrationMethod);
+		}
+
+		EphemerisError error;
+		error.time = point.time;
+		error.simulated = probe.position;
+		error.reference = point.position;
+		error.positionError = (probe.position - point.position).getLength();
+		errors.push_back(error);
+	}
+}
+
+int validateEphemeris(const io::path& ephemerisDirectory, const io::path& reportFile, double timeStep, int integrationMethod, u32 threadCount)
+{
+	array<Body*> bodies = createBodies();
+
+	array<array<EphemerisPoint> > references;
+	array<array<EphemerisError> > errors;
+	for (u32 i = 0; i < bodies.size(); i++)
+	{
+		references.push_back(array<EphemerisPoint>());
+		errors.push_back(array<EphemerisError>());
+
+		//The Sun is the fixed central body, so there is nothing to compare it against.
+		if (i > 0)
+		{
+			io::path fileName = ephemerisDirectory;
+			fileName += io::path(bodies[i]->name);
+			fileName += ".txt";
+			if (!loadEphemeris(fileName, references[i]))
+			{
+				printf("No reference ephemeris for %s (%s)\n", core::stringc(bodies[i]->name).c_str(), fileName.c_str());
+			}
+		}
+	}
+
+	//Bodies only feel the Sun, so every body is integrated independently on its own worker.
+	if (threadCount == 0)
+	{
+		threadCount = std::thread::hardware_concurrency();
+	}
+	threadCount = core::clamp<u32>(threadCount, 1, bodies.size());
+
+	std::atomic<u32> nextBody(1);
+	std::vector<std::thread> workers;
+	for (u32 t = 0; t < threadCount; t++)
+	{
+		workers.push_back(std::thread([&]()
+		{
+			for (u32 i = nextBody++; i < bodies.size(); i = nextBody++)
+			{
+				compareWithEphemeris(bodies[0], bodies[i], references[i], timeStep, integrationMethod, errors[i]);
+			}
+		}));
+	}
+
+	for (u32 t = 0; t < workers.size(); t++)
+	{
+		workers[t].join();
+	}
+
+	FILE* report = fopen(reportFile.c_str(), "w");
+	if (!report)
+	{
+		printf("Could not write ephemeris report %s\n", reportFile.c_str());
+		return 1;
+	}
+
+	fprintf(report, "body,time,x,y,z,reference_x,reference_y,reference_z,position_error\n");
+	for (u32 i = 1; i < bodies.size(); i++)
+	{
+		core::stringc name(bodies[i]->name);
+		for (u32 j = 0; j < errors[i].size(); j++)
+		{
+			const EphemerisError& error = errors[i][j];
+			fprintf(report, "%s,%.1f,%.9e,%.9e,%.9e,%.9e,%.9e,%.9e,%.9e\n",
+				name.c_str(), error.time,
+				error.simulated.X, error.simulated.Y, error.simulated.Z,
+				error.reference.X, error.reference.Y, error.reference.Z,
+				error.positionError);
+		}
+	}
+
+	for (u32 i = 1; i < bodies.size(); i++)
+	{
+		double maxError = 0;
+		double sumSquared = 0;
+		for (u32 j = 0; j < errors[i].size(); j++)
+		{
+			maxError = core::max_(maxError, errors[i][j].positionError);
+			sumSquared += errors[i][j].positionError * errors[i][j].positionError;
+		}
+
+		if (!errors[i].empty())
+		{
+			fprintf(report, "# %s: %u epochs, max error %.6e m, rms error %.6e m\n",
+				core::stringc(bodies[i]->name).c_str(), errors[i].size(), maxError, sqrt(sumSquared / errors[i].size()));
+		}
+	}
+
+	fclose(report);
+
+	for (u32 i = 0; i < bodies.size(); i++)
+	{
+		delete bodies[i];
+	}
+
+	return 0;
+}
@@ -0,0 +1,32 @@
+#pragma once
+#include "Body.h"
+using namespace irr;
+using namespace core;
+
+//Reference ephemerides are plain text files, one per body, named "<Body name>.txt".
+//Every line holds "time x y z" separated by spaces or commas, where time is seconds since the
+//createBodies() epoch (A.D. 2000-Jan-01 00:00:00.0000 CT) and x y z is the heliocentric position in metres.
+//Empty lines and lines starting with '#' are ignored.
+
+struct EphemerisPoint
+{
+	double time;
+	vector3d<double> position;
+
+	bool operator<(const EphemerisPoint& other) const
+	{
+		return time < other.time;
+	}
+};
+
+struct EphemerisError
+{
+	double time;
+	vector3d<double> simulated;
+	vector3d<double> reference;
+	double positionError;
+};
+
+bool loadEphemeris(const io::path& fileName, array<EphemerisPoint>& points);
+void compareWithEphemeris(const Body* sun, const Body* body, const array<EphemerisPoint>& reference, double timeStep, int integrationMethod, array<EphemerisError>& errors);
+int validateEphemeris(const io::path& ephemerisDirectory, const io::path& reportFile, double timeStep, int integrationMethod, u32 threadCount);
@@ -0,0 +1,40 @@
+#include "FollowCamera.h"
+
+FollowCamera::FollowCamera()
+{
+	body = 0;
+}
+
+void FollowCamera::follow(Body* body, scene::ICameraSceneNode* camera, const RenderFrame& frame)
+{
+	this->body = body;
+	lastPosition = frame.toScaled(frame.drawPosition(body));
+	camera->setTarget(frame.scaledToRender(lastPosition));
+}
+
+void FollowCamera::stop()
+{
+	body = 0;
+}
+
+Body* FollowCamera::getBody() const
+{
+	return body;
+}
+
+void FollowCamera::update(scene::ICameraSceneNode* camera, const RenderFrame& frame)
+{
+	if (!body)
+	{
+		return;
+	}
+
+	vector3d<double> position = frame.toScaled(frame.drawPosition(body));
+	vector3d<double> moved = position - lastPosition;
+	vector3df offset((f32)moved.X, (f32)moved.Y, (f32)moved.Z);
+	lastPosition = position;
+
+	camera->setPosition(camera->getPosition() + offset);
+	camera->setTarget(camera->getTarget() + offset);
+	camera->updateAbsolutePosition();
+}
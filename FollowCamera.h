@@ -0,0 +1,25 @@
+#pragma once
+#include <irrlicht.h>
+#include "Body.h"
+#include "RenderFrame.h"
+using namespace irr;
+using namespace core;
+
+//Moves the camera along with a body, so it keeps its offset while the body orbits.
+//The camera's own controls still turn it and move it relative to the body.
+class FollowCamera
+{
+public:
+	FollowCamera();
+
+	void follow(Body* body, scene::ICameraSceneNode* camera, const RenderFrame& frame);
+	void stop();
+	Body* getBody() const;
+
+	//Call once per frame after the frame's interpolation is set.
+	void update(scene::ICameraSceneNode* camera, const RenderFrame& frame);
+
+private:
+	Body* body;
+	vector3d<double> lastPosition; //Scaled, so it is unaffected by the render origin moving.
+};
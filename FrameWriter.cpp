@@ -0,0 +1,135 @@
+#include "FrameWriter.h"
+#include <cstdio>
+
+FrameWriter::FrameWriter(IrrlichtDevice* device, const io::path& pathPrefix, const io::path& extension, u32 threadCount, u32 maxQueued)
+{
+	driver = device->getVideoDriver();
+	fileSystem = device->getFileSystem();
+	this->pathPrefix = pathPrefix;
+	this->extension = extension;
+	this->maxQueued = core::max_<u32>(maxQueued, 1);
+	stopping = false;
+	failed = 0;
+
+	imageWriter = 0;
+	for (u32 i = 0; i < driver->getImageWriterCount(); i++)
+	{
+		if (driver->getImageWriter(i)->isAWriteableFileExtension(extension))
+		{
+			imageWriter = driver->getImageWriter(i);
+			break;
+		}
+	}
+	if (!imageWriter)
+	{
+		printf("No image writer for %s frames\n", extension.c_str());
+		return;
+	}
+
+	if (threadCount == 0)
+	{
+		threadCount = std::thread::hardware_concurrency();
+	}
+	threadCount = core::max_<u32>(threadCount, 1);
+
+	for (u32 t = 0; t < threadCount; t++)
+	{
+		writers.push_back(std::thread(&FrameWriter::write, this));
+	}
+}
+
+FrameWriter::~FrameWriter()
+{
+	finish();
+}
+
+void FrameWriter::finish()
+{
+	//Frames still queued are written before returning.
+	{
+		std::lock_guard<std::mutex> lock(queueLock);
+		stopping = true;
+	}
+	queueChanged.notify_all();
+
+	for (u32 t = 0; t < writers.size(); t++)
+	{
+		writers[t].join();
+	}
+	writers.clear();
+}
+
+bool FrameWriter::isOpen() const
+{
+	return imageWriter != 0;
+}
+
+bool FrameWriter::capture(u32 frame)
+{
+	if (writers.empty())
+	{
+		failed++;
+		return false;
+	}
+
+	c8 number[16];
+	sprintf(number, "%06u", frame);
+	io::path filename = pathPrefix + number + extension;
+
+	//Reading the frame buffer and opening the file stay on the render thread, only the writer itself runs in the pool.
+	Job job;
+	job.image = driver->createScreenShot();
+	if (!job.image)
+	{
+		failed++;
+		return false;
+	}
+	job.file = fileSystem->createAndWriteFile(filename);
+	if (!job.file)
+	{
+		printf("Could not open %s\n", filename.c_str());
+		job.image->drop();
+		failed++;
+		return false;
+	}
+
+	{
+		std::unique_lock<std::mutex> lock(queueLock);
+		queueShrunk.wait(lock, [this]() { return queue.size() < maxQueued; });
+		queue.push_back(job);
+	}
+	queueChanged.notify_one();
+	return true;
+}
+
+u32 FrameWriter::getFailed() const
+{
+	return failed;
+}
+
+void FrameWriter::write()
+{
+	std::unique_lock<std::mutex> lock(queueLock);
+	while (true)
+	{
+		queueChanged.wait(lock, [this]() { return stopping || !queue.empty(); });
+
+		if (queue.empty())
+		{
+			return;
+		}
+
+		Job job = queue.front();
+		queue.pop_front();
+		queueShrunk.notify_one();
+
+		lock.unlock();
+		if (!imageWriter->writeImage(job.file, job.image))
+		{
+			failed++;
+		}
+		job.file->drop();
+		job.image->drop();
+		lock.lock();
+	}
+}
@@ -0,0 +1,49 @@
+#pragma once
+#include <irrlicht.h>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+using namespace irr;
+using namespace core;
+
+//Saves screenshots as numbered image files, the file type comes from the extension of the path.
+//Compression runs on a pool of background threads; the render loop only waits when maxQueued frames are still unwritten.
+class FrameWriter
+{
+public:
+	FrameWriter(IrrlichtDevice* device, const io::path& pathPrefix, const io::path& extension, u32 threadCount, u32 maxQueued);
+	~FrameWriter();
+
+	//False if no image writer handles the extension, every capture would then fail.
+	bool isOpen() const;
+	bool capture(u32 frame);
+	void finish();
+	u32 getFailed() const;
+
+private:
+	struct Job
+	{
+		video::IImage* image;
+		io::IWriteFile* file;
+	};
+
+	void write();
+
+	video::IVideoDriver* driver;
+	io::IFileSystem* fileSystem;
+	video::IImageWriter* imageWriter;
+	io::path pathPrefix;
+	io::path extension;
+	u32 maxQueued;
+
+	std::vector<std::thread> writers;
+	std::mutex queueLock;
+	std::condition_variable queueChanged;
+	std::condition_variable queueShrunk;
+	std::deque<Job> queue;
+	bool stopping;
+	std::atomic<u32> failed;
+};
@@ -0,0 +1,38 @@
+#include "InputReceiver.h"
+
+InputReceiver::InputReceiver()
+{
+	for (u32 i = 0; i < KEY_KEY_CODES_COUNT; i++)
+	{
+		pressed[i] = false;
+	}
+	leftClicked = false;
+}
+
+bool InputReceiver::OnEvent(const SEvent& event)
+{
+	if (event.EventType == EET_KEY_INPUT_EVENT && event.KeyInput.PressedDown)
+	{
+		pressed[event.KeyInput.Key] = true;
+	}
+	else if (event.EventType == EET_MOUSE_INPUT_EVENT && event.MouseInput.Event == EMIE_LMOUSE_PRESSED_DOWN)
+	{
+		leftClicked = true;
+	}
+
+	return false;
+}
+
+bool InputReceiver::wasKeyPressed(EKEY_CODE key)
+{
+	bool wasPressed = pressed[key];
+	pressed[key] = false;
+	return wasPressed;
+}
+
+bool InputReceiver::wasLeftClicked()
+{
+	bool wasClicked = leftClicked;
+	leftClicked = false;
+	return wasClicked;
+}
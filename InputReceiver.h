@@ -0,0 +1,21 @@
+#pragma once
+#include <irrlicht.h>
+using namespace irr;
+using namespace core;
+
+//Remembers key presses and mouse clicks until they are asked for. Events are never consumed,
+//so the camera and the GUI still see them.
+class InputReceiver : public IEventReceiver
+{
+public:
+	InputReceiver();
+
+	virtual bool OnEvent(const SEvent& event);
+
+	bool wasKeyPressed(EKEY_CODE key);
+	bool wasLeftClicked();
+
+private:
+	bool pressed[KEY_KEY_CODES_COUNT];
+	bool leftClicked;
+};
@@ -0,0 +1,253 @@
+#include "LabelRenderer.h"
+#include <cwchar>
+
+LabelRenderer::LabelRenderer(IrrlichtDevice* device, u32 cellWidth, u32 cellHeight, u32 readoutLines)
+{
+	driver = device->getVideoDriver();
+	font = device->getGUIEnvironment()->getSkin()->getFont();
+	bitmapFont = font && font->getType() == gui::EGFT_BITMAP ? (gui::IGUIFontBitmap*)font : 0;
+
+	if (bitmapFont)
+	{
+		u32 textures = bitmapFont->getSpriteBank()->getTextureCount();
+		batchPositions.set_used(textures);
+		batchRects.set_used(textures);
+	}
+
+	readouts.set_used(readoutLines);
+	for (u32 i = 0; i < readouts.size(); i++)
+	{
+		readouts[i].text[0] = 0;
+		readouts[i].run.size = dimension2d<s32>(0, 0);
+	}
+
+	this->cellWidth = core::max_<u32>(cellWidth, 1);
+	this->cellHeight = core::max_<u32>(cellHeight, 1);
+	columns = 0;
+	rows = 0;
+	stamp = 0;
+	labelsDrawn = 0;
+	labelsHidden = 0;
+}
+
+void LabelRenderer::layout(const wchar_t* text, GlyphRun& run) const
+{
+	run.textures.set_used(0);
+	run.sourceRects.set_used(0);
+	run.offsets.set_used(0);
+	run.size = dimension2d<s32>(0, 0);
+
+	gui::IGUISpriteBank* bank = bitmapFont->getSpriteBank();
+	s32 x = 0;
+	for (const wchar_t* c = text; *c; c++)
+	{
+		const gui::SGUISprite& sprite = bank->getSprites()[bitmapFont->getSpriteNoFromChar(c)];
+		if (sprite.Frames.empty())
+		{
+			continue;
+		}
+		const rect<s32>& source = bank->getPositions()[sprite.Frames[0].rectNumber];
+
+		run.textures.push_back(sprite.Frames[0].textureNumber);
+		run.sourceRects.push_back(source);
+		run.offsets.push_back(position2di(x, 0));
+
+		x += source.getWidth() + bitmapFont->getKerningWidth(c, c > text ? c - 1 : 0);
+		run.size.Height = core::max_(run.size.Height, source.getHeight());
+	}
+	run.size.Width = x;
+}
+
+const GlyphRun& LabelRenderer::getRun(const stringw& text)
+{
+	std::map<stringw, GlyphRun>::iterator it = runs.find(text);
+	if (it != runs.end())
+	{
+		return it->second;
+	}
+
+	GlyphRun& run = runs[text];
+	layout(text.c_str(), run);
+	return run;
+}
+
+bool LabelRenderer::claim(const rect<s32>& area)
+{
+	s32 minX = core::max_(area.UpperLeftCorner.X, 0) / (s32)cellWidth;
+	s32 minY = core::max_(area.UpperLeftCorner.Y, 0) / (s32)cellHeight;
+	s32 maxX = core::min_(area.LowerRightCorner.X / (s32)cellWidth, (s32)columns - 1);
+	s32 maxY = core::min_(area.LowerRightCorner.Y / (s32)cellHeight, (s32)rows - 1);
+
+	for (s32 y = minY; y <= maxY; y++)
+	{
+		for (s32 x = minX; x <= maxX; x++)
+		{
+			if (claimed[y * columns + x] == stamp)
+			{
+				return false;
+			}
+		}
+	}
+
+	for (s32 y = minY; y <= maxY; y++)
+	{
+		for (s32 x = minX; x <= maxX; x++)
+		{
+			claimed[y * columns + x] = stamp;
+		}
+	}
+	return true;
+}
+
+void LabelRenderer::queue(const GlyphRun& run, const position2di& position)
+{
+	for (u32 i = 0; i < run.sourceRects.size(); i++)
+	{
+		batchPositions[run.textures[i]].push_back(position + run.offsets[i]);
+		batchRects[run.textures[i]].push_back(run.sourceRects[i]);
+	}
+}
+
+void LabelRenderer::flush(video::SColor color)
+{
+	for (u32 t = 0; t < batchPositions.size(); t++)
+	{
+		if (!batchPositions[t].empty())
+		{
+			driver->draw2DImageBatch(bitmapFont->getSpriteBank()->getTexture(t), batchPositions[t], batchRects[t], 0, color, true);
+			batchPositions[t].set_used(0);
+			batchRects[t].set_used(0);
+		}
+	}
+}
+
+void LabelRenderer::drawLabels(const array<Body*>& bodies, const Body* highlighted, scene::ICameraSceneNode* camera)
+{
+	labelsDrawn = 0;
+	labelsHidden = 0;
+	if (!font)
+	{
+		return;
+	}
+
+	dimension2d<u32> screen = driver->getScreenSize();
+	columns = (screen.Width + cellWidth - 1) / cellWidth;
+	rows = (screen.Height + cellHeight - 1) / cellHeight;
+	if (claimed.size() != columns * rows)
+	{
+		claimed.set_used(columns * rows);
+		for (u32 i = 0; i < claimed.size(); i++)
+		{
+			claimed[i] = 0;
+		}
+		stamp = 0;
+	}
+	//A new stamp frees every cell without clearing the grid.
+	stamp++;
+
+	matrix4 viewProjection = camera->getProjectionMatrix() * camera->getViewMatrix();
+
+	for (s32 i = -1; i < (s32)bodies.size(); i++)
+	{
+		const Body* body = i < 0 ? highlighted : bodies[i];
+		if (!body || body->removed || !body->visual || !body->visual->sphere || (i >= 0 && body == highlighted))
+		{
+			continue;
+		}
+
+		vector3df position = body->visual->sphere->getPosition();
+		f32 clip[4] = { position.X, position.Y, position.Z, 1 };
+		viewProjection.multiplyWith1x4Matrix(clip);
+		if (clip[3] <= 0)
+		{
+			continue;
+		}
+
+		//Just right of the body's centre, vertically centred on it.
+		const GlyphRun& run = getRun(body->name);
+		position2di corner((s32)((clip[0] / clip[3] * 0.5f + 0.5f) * screen.Width) + 6, (s32)((0.5f - clip[1] / clip[3] * 0.5f) * screen.Height) - run.size.Height / 2);
+		rect<s32> area(corner, run.size);
+		if (area.LowerRightCorner.X < 0 || area.LowerRightCorner.Y < 0 || area.UpperLeftCorner.X >= (s32)screen.Width || area.UpperLeftCorner.Y >= (s32)screen.Height)
+		{
+			continue;
+		}
+
+		if (!claim(area))
+		{
+			labelsHidden++;
+			continue;
+		}
+		labelsDrawn++;
+
+		if (bitmapFont)
+		{
+			queue(run, corner);
+		}
+		else
+		{
+			font->draw(body->name, area, video::SColor(255, 255, 255, 255));
+		}
+	}
+
+	if (bitmapFont)
+	{
+		flush(video::SColor(255, 255, 255, 255));
+	}
+}
+
+void LabelRenderer::setReadout(u32 line, const wchar_t* text)
+{
+	Readout& readout = readouts[line];
+	if (wcsncmp(readout.text, text, 63) == 0)
+	{
+		return;
+	}
+
+	wcsncpy(readout.text, text, 63);
+	readout.text[63] = 0;
+	if (bitmapFont)
+	{
+		layout(readout.text, readout.run);
+	}
+}
+
+void LabelRenderer::drawReadouts(const position2di& bottomLeft)
+{
+	if (!font)
+	{
+		return;
+	}
+
+	s32 lineHeight = font->getDimension(L"0").Height + 2;
+	position2di corner(bottomLeft.X, bottomLeft.Y - lineHeight * readouts.size());
+	for (u32 i = 0; i < readouts.size(); i++)
+	{
+		if (readouts[i].text[0])
+		{
+			if (bitmapFont)
+			{
+				queue(readouts[i].run, corner);
+			}
+			else
+			{
+				font->draw(readouts[i].text, rect<s32>(corner, dimension2d<s32>(1000, lineHeight)), video::SColor(255, 255, 255, 255));
+			}
+		}
+		corner.Y += lineHeight;
+	}
+
+	if (bitmapFont)
+	{
+		flush(video::SColor(255, 255, 255, 255));
+	}
+}
+
+u32 LabelRenderer::getLabelsDrawn() const
+{
+	return labelsDrawn;
+}
+
+u32 LabelRenderer::getLabelsHidden() const
+{
+	return labelsHidden;
+}
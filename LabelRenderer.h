@@ -0,0 +1,67 @@
+#pragma once
+#include <irrlicht.h>
+#include <map>
+#include "BodyVisual.h"
+using namespace irr;
+using namespace core;
+
+//One piece of text laid out with a bitmap font: where each glyph sits in the font's textures and relative to the text's top left.
+struct GlyphRun
+{
+	array<u32> textures;
+	array<rect<s32> > sourceRects;
+	array<position2di> offsets;
+	dimension2d<s32> size;
+};
+
+//Body name labels and a few lines of readouts, drawn from glyph runs that are laid out once and reused.
+//Names are laid out the first time they are seen, readouts only when their text changes, and every glyph
+//on screen goes out in one batched draw per font texture. Labels are decluttered in one pass over a screen grid:
+//in priority order each label claims the cells it covers and is skipped if any of them is already taken.
+class LabelRenderer
+{
+public:
+	LabelRenderer(IrrlichtDevice* device, u32 cellWidth, u32 cellHeight, u32 readoutLines);
+
+	//Labels bodies that have a sphere, highlighted first. Call after the scene is drawn, when the camera's matrices are current.
+	void drawLabels(const array<Body*>& bodies, const Body* highlighted, scene::ICameraSceneNode* camera);
+
+	//Lays the line out again only if the text differs from what it already shows.
+	void setReadout(u32 line, const wchar_t* text);
+	void drawReadouts(const position2di& bottomLeft);
+
+	u32 getLabelsDrawn() const;
+	u32 getLabelsHidden() const;
+
+private:
+	struct Readout
+	{
+		wchar_t text[64];
+		GlyphRun run;
+	};
+
+	const GlyphRun& getRun(const stringw& text);
+	void layout(const wchar_t* text, GlyphRun& run) const;
+	bool claim(const rect<s32>& area);
+	void queue(const GlyphRun& run, const position2di& position);
+	void flush(video::SColor color);
+
+	video::IVideoDriver* driver;
+	gui::IGUIFont* font;
+	gui::IGUIFontBitmap* bitmapFont; //0 if the font has no sprite bank, text is then drawn with the font directly.
+	std::map<stringw, GlyphRun> runs;
+	array<Readout> readouts;
+
+	array<array<position2di> > batchPositions; //Per font texture.
+	array<array<rect<s32> > > batchRects;
+
+	u32 cellWidth;
+	u32 cellHeight;
+	u32 columns;
+	u32 rows;
+	array<u32> claimed; //Frame stamp of the last label to claim each cell.
+	u32 stamp;
+
+	u32 labelsDrawn;
+	u32 labelsHidden;
+};
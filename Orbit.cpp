@@ -0,0 +1,51 @@
+#include "Orbit.h"
+#include <cmath>
+
+bool OrbitalElements::isBound() const
+{
+	return semiMajorAxis > 0 && eccentricity < 1;
+}
+
+OrbitalElements orbitalElements(const vector3d<double>& position, const vector3d<double>& velocity, double mu)
+{
+	OrbitalElements elements;
+
+	double distance = position.getLength();
+	vector3d<double> angularMomentum = position.crossProduct(velocity);
+	elements.normal = angularMomentum;
+	elements.normal.normalize();
+
+	//Vis-viva for the size, the Laplace-Runge-Lenz vector for shape and orientation.
+	elements.semiMajorAxis = 1 / (2 / distance - velocity.getLengthSQ() / mu);
+	elements.eccentricityVector = velocity.crossProduct(angularMomentum) / mu - position / distance;
+	elements.eccentricity = elements.eccentricityVector.getLength();
+
+	if (elements.eccentricity > 1e-12)
+	{
+		elements.periapsisDirection = elements.eccentricityVector / elements.eccentricity;
+	}
+	else
+	{
+		elements.periapsisDirection = position / distance;
+	}
+
+	return elements;
+}
+
+//Tolerance is relative for the semi-major axis and absolute for the eccentricity vector and the orbit normal.
+bool elementsDiffer(const OrbitalElements& a, const OrbitalElements& b, double tolerance)
+{
+	return fabs(a.semiMajorAxis - b.semiMajorAxis) > tolerance * fabs(b.semiMajorAxis) ||
+		a.eccentricityVector.getDistanceFromSQ(b.eccentricityVector) > tolerance * tolerance ||
+		a.normal.getDistanceFromSQ(b.normal) > tolerance * tolerance;
+}
+
+//Position relative to the central mass on a bound orbit.
+vector3d<double> orbitPoint(const OrbitalElements& elements, double eccentricAnomaly)
+{
+	vector3d<double> q = elements.normal.crossProduct(elements.periapsisDirection);
+	double a = elements.semiMajorAxis;
+	double b = a * sqrt(1 - elements.eccentricity * elements.eccentricity);
+
+	return elements.periapsisDirection * (a * (cos(eccentricAnomaly) - elements.eccentricity)) + q * (b * sin(eccentricAnomaly));
+}
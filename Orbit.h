@@ -0,0 +1,21 @@
+#pragma once
+#include "CoreTypes.h"
+using namespace irr;
+using namespace core;
+
+//Osculating two body orbit of a body around a central mass, from its state relative to that mass.
+//Orientation is kept as vectors rather than angles, so circular and equatorial orbits need no special cases.
+struct OrbitalElements
+{
+	double semiMajorAxis; //Negative for unbound orbits.
+	double eccentricity;
+	vector3d<double> eccentricityVector; //Points at periapsis, length is the eccentricity.
+	vector3d<double> normal; //Unit angular momentum.
+	vector3d<double> periapsisDirection; //Any direction in the orbital plane for circular orbits.
+
+	bool isBound() const;
+};
+
+OrbitalElements orbitalElements(const vector3d<double>& position, const vector3d<double>& velocity, double mu);
+bool elementsDiffer(const OrbitalElements& a, const OrbitalElements& b, double tolerance);
+vector3d<double> orbitPoint(const OrbitalElements& elements, double eccentricAnomaly);
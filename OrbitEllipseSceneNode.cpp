@@ -0,0 +1,121 @@
+#include "OrbitEllipseSceneNode.h"
+
+OrbitEllipseSceneNode::OrbitEllipseSceneNode(scene::ISceneNode* parent, scene::ISceneManager* mgr, u32 segments, video::SColor color)
+	: scene::ISceneNode(parent, mgr, -1)
+{
+	this->color = color;
+	built = false;
+
+	segments = core::clamp<u32>(segments, 8, 0xFFFE);
+	vertices.set_used(segments);
+
+	//The last index repeats the first vertex to close the loop.
+	indices.set_used(segments + 1);
+	for (u32 i = 0; i < segments; i++)
+	{
+		indices[i] = i;
+	}
+	indices[segments] = 0;
+
+	material.Lighting = false;
+	material.Thickness = 1;
+
+	setAutomaticCulling(scene::EAC_BOX);
+}
+
+bool OrbitEllipseSceneNode::update(const vector3d<double>& focus, const vector3d<double>& position, const vector3d<double>& velocity, double mu, double tolerance, const RenderFrame& frame)
+{
+	OrbitalElements current = orbitalElements(position, velocity, mu);
+
+	//Unbound orbits have no ellipse to draw.
+	if (!current.isBound())
+	{
+		built = false;
+		elements = current;
+		return false;
+	}
+
+	if (built && !elementsDiffer(current, elements, tolerance) && focus == this->focus)
+	{
+		return false;
+	}
+
+	elements = current;
+	this->focus = focus;
+	rebuild(frame);
+	return true;
+}
+
+void OrbitEllipseSceneNode::rebuild(const RenderFrame& frame)
+{
+	scaledFocus = frame.toScaled(focus);
+
+	//Even steps in eccentric anomaly put more points near periapsis, where the curve bends most.
+	for (u32 i = 0; i < vertices.size(); i++)
+	{
+		double eccentricAnomaly = 2 * PI64 * i / vertices.size();
+		vector3d<double> scaled = frame.toScaled(focus + orbitPoint(elements, eccentricAnomaly)) - scaledFocus;
+		vector3df point((f32)scaled.X, (f32)scaled.Y, (f32)scaled.Z);
+		vertices[i] = video::S3DVertex(point, vector3df(0), color, vector2df(0));
+
+		if (i == 0)
+		{
+			box.reset(point);
+		}
+		else
+		{
+			box.addInternalPoint(point);
+		}
+	}
+
+	built = true;
+}
+
+void OrbitEllipseSceneNode::prepareDraw(const RenderFrame& frame)
+{
+	setPosition(frame.scaledToRender(scaledFocus));
+}
+
+u32 OrbitEllipseSceneNode::size() const
+{
+	return built ? vertices.size() : 0;
+}
+
+vector3df OrbitEllipseSceneNode::getPoint(u32 i) const
+{
+	return vertices[i].Pos + getPosition();
+}
+
+void OrbitEllipseSceneNode::OnRegisterSceneNode()
+{
+	if (IsVisible && built)
+	{
+		SceneManager->registerNodeForRendering(this, scene::ESNRP_SOLID);
+	}
+
+	ISceneNode::OnRegisterSceneNode();
+}
+
+void OrbitEllipseSceneNode::render()
+{
+	video::IVideoDriver* driver = SceneManager->getVideoDriver();
+	driver->setMaterial(material);
+	driver->setTransform(video::ETS_WORLD, AbsoluteTransformation);
+
+	driver->drawVertexPrimitiveList(vertices.const_pointer(), vertices.size(), indices.const_pointer(), vertices.size(), video::EVT_STANDARD, scene::EPT_LINE_STRIP, video::EIT_16BIT);
+}
+
+const aabbox3df& OrbitEllipseSceneNode::getBoundingBox() const
+{
+	return box;
+}
+
+u32 OrbitEllipseSceneNode::getMaterialCount() const
+{
+	return 1;
+}
+
+video::SMaterial& OrbitEllipseSceneNode::getMaterial(u32 /*i*/)
+{
+	return material;
+}
@@ -0,0 +1,40 @@
+#pragma once
+#include <irrlicht.h>
+#include "Orbit.h"
+#include "RenderFrame.h"
+using namespace irr;
+using namespace core;
+
+//A body's current osculating Kepler ellipse drawn as a closed line strip around its central mass.
+//Vertices are only rebuilt when the elements have drifted by more than a tolerance since they were last built,
+//and like trails they are stored relative to the focus so only the node moves with the render origin.
+class OrbitEllipseSceneNode : public scene::ISceneNode
+{
+public:
+	OrbitEllipseSceneNode(scene::ISceneNode* parent, scene::ISceneManager* mgr, u32 segments, video::SColor color);
+
+	//Position and velocity are relative to the central mass at focus. Returns true if the ellipse was rebuilt.
+	bool update(const vector3d<double>& focus, const vector3d<double>& position, const vector3d<double>& velocity, double mu, double tolerance, const RenderFrame& frame);
+	void prepareDraw(const RenderFrame& frame);
+	u32 size() const;
+	vector3df getPoint(u32 i) const; //Render position of the i-th point around the ellipse.
+
+	virtual void OnRegisterSceneNode();
+	virtual void render();
+	virtual const aabbox3df& getBoundingBox() const;
+	virtual u32 getMaterialCount() const;
+	virtual video::SMaterial& getMaterial(u32 i);
+
+private:
+	void rebuild(const RenderFrame& frame);
+
+	OrbitalElements elements;
+	bool built;
+	vector3d<double> focus;
+	vector3d<double> scaledFocus;
+	array<video::S3DVertex> vertices;
+	array<u16> indices;
+	video::SColor color;
+	aabbox3df box;
+	video::SMaterial material;
+};
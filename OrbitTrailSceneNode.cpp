@@ -0,0 +1,163 @@
+#include "OrbitTrailSceneNode.h"
+
+//Caps the work per append, on the rare stretch that stays within tolerance for a long time.
+static const u32 MAX_PASSED_POINTS = 64;
+
+OrbitTrailSceneNode::OrbitTrailSceneNode(scene::ISceneNode* parent, scene::ISceneManager* mgr, u32 capacity, double tolerance, video::SColor color)
+	: scene::ISceneNode(parent, mgr, -1)
+{
+	this->color = color;
+	this->tolerance = tolerance;
+	head = 0;
+	count = 0;
+
+	//Indices are 16 bit and the strip needs at least two points.
+	capacity = core::clamp<u32>(capacity, 2, 0xFFFF);
+	vertices.set_used(capacity);
+
+	//The index list holds the ring twice, so the oldest to newest points are always one contiguous run
+	//starting at the oldest point and never have to be rewritten.
+	indices.set_used(capacity * 2);
+	for (u32 i = 0; i < capacity; i++)
+	{
+		indices[i] = i;
+		indices[i + capacity] = i;
+	}
+
+	material.Lighting = false;
+	material.Thickness = 1;
+
+	setAutomaticCulling(scene::EAC_BOX);
+}
+
+void OrbitTrailSceneNode::append(const vector3d<double>& scaledPoint)
+{
+	if (count == 0)
+	{
+		anchor = scaledPoint;
+		box.reset(vector3df(0));
+	}
+	last = scaledPoint;
+
+	if (count == 0 || passed.empty())
+	{
+		//The first point is fixed right away, the next one starts a new moving vertex.
+		if (count == 0)
+		{
+			lastFixed = scaledPoint;
+		}
+		else
+		{
+			passed.push_back(scaledPoint);
+		}
+	}
+	else if (passed.size() < MAX_PASSED_POINTS && !strays(scaledPoint))
+	{
+		//Still within tolerance, so the moving vertex just follows the body.
+		passed.push_back(scaledPoint);
+		write((head + vertices.size() - 1) % vertices.size(), scaledPoint);
+		return;
+	}
+	else
+	{
+		//The moving vertex stays where it is and a new one starts at the body.
+		lastFixed = passed.getLast();
+		passed.set_used(0);
+		passed.push_back(scaledPoint);
+	}
+
+	write(head, scaledPoint);
+	head = (head + 1) % vertices.size();
+	count = core::min_(count + 1, vertices.size());
+}
+
+void OrbitTrailSceneNode::write(u32 slot, const vector3d<double>& scaledPoint)
+{
+	vector3df point((f32)(scaledPoint.X - anchor.X), (f32)(scaledPoint.Y - anchor.Y), (f32)(scaledPoint.Z - anchor.Z));
+	vertices[slot] = video::S3DVertex(point, vector3df(0), color, vector2df(0));
+	box.addInternalPoint(point);
+}
+
+//Whether a line from lastFixed to scaledPoint passes further than the tolerance from any point passed on the way.
+bool OrbitTrailSceneNode::strays(const vector3d<double>& scaledPoint) const
+{
+	vector3d<double> segment = scaledPoint - lastFixed;
+	double lengthSQ = segment.getLengthSQ();
+	double toleranceSQ = tolerance * tolerance;
+
+	for (u32 i = 0; i < passed.size(); i++)
+	{
+		vector3d<double> offset = passed[i] - lastFixed;
+		double t = lengthSQ > 0 ? core::clamp(offset.dotProduct(segment) / lengthSQ, 0.0, 1.0) : 0;
+		if ((offset - segment * t).getLengthSQ() > toleranceSQ)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+void OrbitTrailSceneNode::clear()
+{
+	head = 0;
+	count = 0;
+	passed.set_used(0);
+	box.reset(vector3df(0));
+}
+
+const vector3d<double>& OrbitTrailSceneNode::getLast() const
+{
+	return last;
+}
+
+u32 OrbitTrailSceneNode::size() const
+{
+	return count;
+}
+
+vector3df OrbitTrailSceneNode::getPoint(u32 i) const
+{
+	u32 oldest = count < vertices.size() ? 0 : head;
+	return vertices[(oldest + i) % vertices.size()].Pos + getPosition();
+}
+
+void OrbitTrailSceneNode::prepareDraw(const RenderFrame& frame)
+{
+	setPosition(frame.scaledToRender(anchor));
+}
+
+void OrbitTrailSceneNode::OnRegisterSceneNode()
+{
+	if (IsVisible && count > 1)
+	{
+		SceneManager->registerNodeForRendering(this, scene::ESNRP_SOLID);
+	}
+
+	ISceneNode::OnRegisterSceneNode();
+}
+
+void OrbitTrailSceneNode::render()
+{
+	video::IVideoDriver* driver = SceneManager->getVideoDriver();
+	driver->setMaterial(material);
+	driver->setTransform(video::ETS_WORLD, AbsoluteTransformation);
+
+	//Irrlicht 1.8 only draws triangles from hardware mapped mesh buffers, so the strip is drawn from client memory.
+	u32 oldest = count < vertices.size() ? 0 : head;
+	driver->drawVertexPrimitiveList(vertices.const_pointer(), vertices.size(), indices.const_pointer() + oldest, count - 1, video::EVT_STANDARD, scene::EPT_LINE_STRIP, video::EIT_16BIT);
+}
+
+const aabbox3df& OrbitTrailSceneNode::getBoundingBox() const
+{
+	return box;
+}
+
+u32 OrbitTrailSceneNode::getMaterialCount() const
+{
+	return 1;
+}
+
+video::SMaterial& OrbitTrailSceneNode::getMaterial(u32 /*i*/)
+{
+	return material;
+}
@@ -0,0 +1,47 @@
+#pragma once
+#include <irrlicht.h>
+#include "RenderFrame.h"
+using namespace irr;
+using namespace core;
+
+//A body's orbit history drawn as one line strip. Points live in a fixed size ring buffer,
+//so appending is constant time and the whole trail is a single draw call. Vertices are stored
+//relative to the first point, and only the node itself is moved when the render origin moves.
+//Appended points are decimated as they arrive: the newest vertex follows the body, and is only left behind
+//once the straight line to the body would stray further than the tolerance from the points passed since.
+//Straight stretches therefore take few vertices and sharp bends many.
+class OrbitTrailSceneNode : public scene::ISceneNode
+{
+public:
+	OrbitTrailSceneNode(scene::ISceneNode* parent, scene::ISceneManager* mgr, u32 capacity, double tolerance, video::SColor color);
+
+	void append(const vector3d<double>& scaledPoint);
+	void clear();
+	const vector3d<double>& getLast() const;
+	u32 size() const;
+	vector3df getPoint(u32 i) const; //Render position of the i-th point, oldest first.
+	void prepareDraw(const RenderFrame& frame);
+
+	virtual void OnRegisterSceneNode();
+	virtual void render();
+	virtual const aabbox3df& getBoundingBox() const;
+	virtual u32 getMaterialCount() const;
+	virtual video::SMaterial& getMaterial(u32 i);
+
+private:
+	void write(u32 slot, const vector3d<double>& scaledPoint);
+	bool strays(const vector3d<double>& scaledPoint) const;
+
+	array<video::S3DVertex> vertices;
+	array<u16> indices;
+	u32 head;
+	u32 count;
+	vector3d<double> anchor;
+	vector3d<double> last;
+	double tolerance;
+	vector3d<double> lastFixed; //Newest vertex that no longer moves.
+	array<vector3d<double> > passed; //Points appended since lastFixed, the newest is the moving vertex.
+	video::SColor color;
+	aabbox3df box;
+	video::SMaterial material;
+};
@@ -0,0 +1,88 @@
+#include "ParticleSceneNode.h"
+
+ParticleSceneNode::ParticleSceneNode(scene::ISceneNode* parent, scene::ISceneManager* mgr, const TestParticles* particles, const RenderFrame* frame, f32 pointSize, video::SColor color)
+	: scene::ISceneNode(parent, mgr, -1)
+{
+	this->particles = particles;
+	this->frame = frame;
+	this->color = color;
+	center = vector3d<double>(0);
+	localScale = 1;
+	relative = false;
+
+	//Points are drawn 65536 at a time, the most that 16 bit indices can address.
+	indices.set_used(0x10000);
+	for (u32 i = 0; i < indices.size(); i++)
+	{
+		indices[i] = i;
+	}
+
+	material.Lighting = false;
+	material.Thickness = pointSize;
+
+	setAutomaticCulling(scene::EAC_OFF);
+}
+
+void ParticleSceneNode::setFrame(const vector3d<double>& center, double localScale)
+{
+	this->center = center;
+	this->localScale = localScale;
+	relative = true;
+}
+
+void ParticleSceneNode::OnRegisterSceneNode()
+{
+	if (IsVisible && particles->size() > 0)
+	{
+		SceneManager->registerNodeForRendering(this, scene::ESNRP_SOLID);
+	}
+
+	ISceneNode::OnRegisterSceneNode();
+}
+
+void ParticleSceneNode::render()
+{
+	u32 count = particles->size();
+	if (vertices.size() != count)
+	{
+		vertices.set_used(count);
+		for (u32 i = 0; i < count; i++)
+		{
+			vertices[i] = video::S3DVertex(vector3df(0), vector3df(0), color, vector2df(0));
+		}
+	}
+
+	if (relative)
+	{
+		frame->toRender(particles->x.data(), particles->y.data(), particles->z.data(), count, center, localScale, vertices.pointer());
+	}
+	else
+	{
+		frame->toRender(particles->x.data(), particles->y.data(), particles->z.data(), count, vertices.pointer());
+	}
+
+	video::IVideoDriver* driver = SceneManager->getVideoDriver();
+	driver->setMaterial(material);
+	driver->setTransform(video::ETS_WORLD, IdentityMatrix);
+
+	for (u32 first = 0; first < count; first += indices.size())
+	{
+		u32 points = core::min_(indices.size(), count - first);
+		driver->drawVertexPrimitiveList(vertices.const_pointer() + first, points, indices.const_pointer(), points, video::EVT_STANDARD, scene::EPT_POINTS, video::EIT_16BIT);
+	}
+}
+
+const aabbox3df& ParticleSceneNode::getBoundingBox() const
+{
+	return box;
+}
+
+u32 ParticleSceneNode::getMaterialCount() const
+{
+	return 1;
+}
+
+video::SMaterial& ParticleSceneNode::getMaterial(u32 /*i*/)
+{
+	return material;
+}
@@ -0,0 +1,35 @@
+#pragma once
+#include <irrlicht.h>
+#include "RenderFrame.h"
+#include "TestParticles.h"
+using namespace irr;
+using namespace core;
+
+//Draws a TestParticles population as points straight from its arrays, without an object per particle.
+class ParticleSceneNode : public scene::ISceneNode
+{
+public:
+	ParticleSceneNode(scene::ISceneNode* parent, scene::ISceneManager* mgr, const TestParticles* particles, const RenderFrame* frame, f32 pointSize, video::SColor color);
+
+	//World position of the central mass the particle positions are relative to, and an extra scale
+	//applied to the relative positions on screen. Without a frame, positions are relative to the Sun.
+	void setFrame(const vector3d<double>& center, double localScale);
+
+	virtual void OnRegisterSceneNode();
+	virtual void render();
+	virtual const aabbox3df& getBoundingBox() const;
+	virtual u32 getMaterialCount() const;
+	virtual video::SMaterial& getMaterial(u32 i);
+
+private:
+	const TestParticles* particles;
+	const RenderFrame* frame;
+	vector3d<double> center;
+	double localScale;
+	bool relative;
+	video::SColor color;
+	array<video::S3DVertex> vertices;
+	array<u16> indices;
+	aabbox3df box;
+	video::SMaterial material;
+};
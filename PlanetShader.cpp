@@ -0,0 +1,86 @@
+#include "PlanetShader.h"
+
+array<PlanetLayers> createPlanetLayers()
+{
+	array<PlanetLayers> layers;
+
+	PlanetLayers earth;
+	earth.planet = "Earth";
+	earth.nightTexture = "resources/planet_textures/texture_earth_night.jpg";
+	earth.cloudTexture = "resources/planet_textures/texture_earth_clouds.jpg";
+	layers.push_back(earth);
+
+	return layers;
+}
+
+PlanetShader::PlanetShader(IrrlichtDevice* device, const io::path& vertexShader, const io::path& pixelShader)
+{
+	driver = device->getVideoDriver();
+	materialType = -1;
+
+	video::IGPUProgrammingServices* gpu = driver->getGPUProgrammingServices();
+	if (gpu && driver->queryFeature(video::EVDF_ARB_GLSL))
+	{
+		materialType = gpu->addHighLevelShaderMaterialFromFiles(vertexShader, "main", video::EVST_VS_1_1, pixelShader, "main", video::EPST_PS_1_1, this);
+	}
+}
+
+bool PlanetShader::isSupported() const
+{
+	return materialType >= 0;
+}
+
+void PlanetShader::apply(const array<Body*>& bodies, const array<PlanetLayers>& layers, TextureLoader* textures)
+{
+	if (!isSupported())
+	{
+		return;
+	}
+
+	for (u32 i = 0; i < layers.size(); i++)
+	{
+		for (u32 j = 0; j < bodies.size(); j++)
+		{
+			BodyVisual* visual = bodies[j]->visual;
+			if (bodies[j]->name != layers[i].planet || !visual || !visual->sphere)
+			{
+				continue;
+			}
+
+			if (textures)
+			{
+				visual->setTexture(1, textures->request(layers[i].nightTexture));
+				visual->setTexture(2, textures->request(layers[i].cloudTexture));
+			}
+			else
+			{
+				//Without a loader there are no loader threads decoding alongside, so the driver loads them directly.
+				visual->setTexture(1, driver->getTexture(layers[i].nightTexture));
+				visual->setTexture(2, driver->getTexture(layers[i].cloudTexture));
+			}
+
+			//Kept in the visual's material, so it survives level of detail mesh swaps.
+			visual->material.MaterialType = (video::E_MATERIAL_TYPE)materialType;
+			visual->sphere->getMaterial(0).MaterialType = visual->material.MaterialType;
+		}
+	}
+}
+
+void PlanetShader::setSunPosition(const vector3df& renderPosition)
+{
+	sunPosition = renderPosition;
+}
+
+void PlanetShader::OnSetConstants(video::IMaterialRendererServices* services, s32 /*userData*/)
+{
+	const matrix4& world = driver->getTransform(video::ETS_WORLD);
+	services->setVertexShaderConstant("world", world.pointer(), 16);
+
+	s32 dayMap = 0;
+	s32 nightMap = 1;
+	s32 cloudMap = 2;
+	services->setPixelShaderConstant("dayMap", &dayMap, 1);
+	services->setPixelShaderConstant("nightMap", &nightMap, 1);
+	services->setPixelShaderConstant("cloudMap", &cloudMap, 1);
+	services->setPixelShaderConstant("sunPosition", &sunPosition.X, 3);
+}
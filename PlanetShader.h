@@ -0,0 +1,40 @@
+#pragma once
+#include <irrlicht.h>
+#include "BodyVisual.h"
+#include "TextureLoader.h"
+using namespace irr;
+using namespace core;
+
+//Extra texture layers of a planet drawn with the planet shader.
+struct PlanetLayers
+{
+	stringw planet;
+	io::path nightTexture;
+	io::path cloudTexture;
+};
+
+array<PlanetLayers> createPlanetLayers();
+
+//GLSL material blending a day texture lit by the Sun, a night texture and a cloud layer.
+//Each body's material is set up once; the Sun position is the only value that changes per frame,
+//and it is the same for every body, as the shader works out the direction to the Sun per pixel.
+class PlanetShader : public video::IShaderConstantSetCallBack
+{
+public:
+	PlanetShader(IrrlichtDevice* device, const io::path& vertexShader, const io::path& pixelShader);
+
+	//False if the driver has no GLSL support, e.g. the software renderer; bodies then keep their plain texture.
+	bool isSupported() const;
+
+	//Switches the bodies named in layers over to the shader, textures are requested from textures if given.
+	void apply(const array<Body*>& bodies, const array<PlanetLayers>& layers, TextureLoader* textures);
+
+	void setSunPosition(const vector3df& renderPosition);
+
+	virtual void OnSetConstants(video::IMaterialRendererServices* services, s32 userData);
+
+private:
+	video::IVideoDriver* driver;
+	s32 materialType;
+	vector3df sunPosition;
+};
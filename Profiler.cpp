@@ -0,0 +1,169 @@
+#include "Profiler.h"
+#include <algorithm>
+#include <cwchar>
+#ifdef _IRR_WINDOWS_
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <chrono>
+#endif
+
+static const wchar_t* phaseNames[PROFILE_PHASE_COUNT] = { L"physics", L"collisions", L"trails", L"prepareDraw", L"drawAll", L"endScene" };
+static const char* phaseColumns[PROFILE_PHASE_COUNT] = { "physics", "collisions", "trails", "prepare_draw", "draw_all", "end_scene" };
+static const char* counterColumns[PROFILE_COUNTER_COUNT] = { "bodies_drawn", "bodies_culled", "trails_drawn", "trails_culled", "labels_drawn", "labels_hidden" };
+
+Profiler::Profiler()
+{
+#ifdef _IRR_WINDOWS_
+	LARGE_INTEGER frequency;
+	QueryPerformanceFrequency(&frequency);
+	secondsPerTick = 1.0 / frequency.QuadPart;
+#else
+	secondsPerTick = (f64)std::chrono::steady_clock::period::num / std::chrono::steady_clock::period::den;
+#endif
+
+	for (u32 i = 0; i < PROFILE_PHASE_COUNT; i++)
+	{
+		started[i] = 0;
+		frame[i] = 0;
+	}
+	for (u32 i = 0; i < PROFILE_COUNTER_COUNT; i++)
+	{
+		counters[i] = 0;
+	}
+	historyHead = 0;
+	historyCount = 0;
+	frameNumber = 0;
+	csv = 0;
+	overlay = 0;
+	text[0] = 0;
+}
+
+Profiler::~Profiler()
+{
+	if (csv)
+	{
+		fclose(csv);
+	}
+}
+
+u64 Profiler::now() const
+{
+#ifdef _IRR_WINDOWS_
+	LARGE_INTEGER counter;
+	QueryPerformanceCounter(&counter);
+	return counter.QuadPart;
+#else
+	return std::chrono::steady_clock::now().time_since_epoch().count();
+#endif
+}
+
+void Profiler::begin(u32 phase)
+{
+	started[phase] = now();
+}
+
+void Profiler::end(u32 phase)
+{
+	//A phase may run several times per frame, e.g. when more than one physics update is due.
+	frame[phase] += (now() - started[phase]) * secondsPerTick * 1000;
+}
+
+void Profiler::endFrame()
+{
+	for (u32 i = 0; i < PROFILE_PHASE_COUNT; i++)
+	{
+		history[i][historyHead] = frame[i];
+	}
+	historyHead = (historyHead + 1) % PROFILE_HISTORY;
+	historyCount = core::min_(historyCount + 1, PROFILE_HISTORY);
+
+	if (csv)
+	{
+		fprintf(csv, "%u", frameNumber);
+		for (u32 i = 0; i < PROFILE_PHASE_COUNT; i++)
+		{
+			fprintf(csv, ",%.4f", frame[i]);
+		}
+		for (u32 i = 0; i < PROFILE_COUNTER_COUNT; i++)
+		{
+			fprintf(csv, ",%u", counters[i]);
+		}
+		fprintf(csv, "\n");
+	}
+
+	for (u32 i = 0; i < PROFILE_PHASE_COUNT; i++)
+	{
+		frame[i] = 0;
+	}
+	frameNumber++;
+}
+
+void Profiler::count(u32 counter, u32 value)
+{
+	counters[counter] = value;
+}
+
+f64 Profiler::percentile(u32 phase, f64 fraction)
+{
+	if (historyCount == 0)
+	{
+		return 0;
+	}
+
+	for (u32 i = 0; i < historyCount; i++)
+	{
+		scratch[i] = history[phase][i];
+	}
+
+	u32 n = core::min_((u32)(fraction * historyCount), historyCount - 1);
+	std::nth_element(scratch, scratch + n, scratch + historyCount);
+	return scratch[n];
+}
+
+bool Profiler::openCsv(const io::path& fileName)
+{
+	csv = fopen(fileName.c_str(), "w");
+	if (!csv)
+	{
+		return false;
+	}
+
+	fprintf(csv, "frame");
+	for (u32 i = 0; i < PROFILE_PHASE_COUNT; i++)
+	{
+		fprintf(csv, ",%s_ms", phaseColumns[i]);
+	}
+	for (u32 i = 0; i < PROFILE_COUNTER_COUNT; i++)
+	{
+		fprintf(csv, ",%s", counterColumns[i]);
+	}
+	fprintf(csv, "\n");
+	return true;
+}
+
+void Profiler::createOverlay(gui::IGUIEnvironment* guienv, const rect<s32>& area)
+{
+	overlay = guienv->addStaticText(L"", area, false, true, 0, -1, true);
+	overlay->setOverrideColor(video::SColor(255, 255, 255, 255));
+	overlay->setBackgroundColor(video::SColor(128, 0, 0, 0));
+}
+
+void Profiler::updateOverlay(f64 fps)
+{
+	if (!overlay)
+	{
+		return;
+	}
+
+	u32 length = swprintf(text, sizeof(text) / sizeof(text[0]), L"FPS %.0f    p50 / p99 ms\n", fps);
+	for (u32 i = 0; i < PROFILE_PHASE_COUNT; i++)
+	{
+		length += swprintf(text + length, sizeof(text) / sizeof(text[0]) - length, L"%-12ls %7.3f / %7.3f\n", phaseNames[i], percentile(i, 0.5), percentile(i, 0.99));
+	}
+	length += swprintf(text + length, sizeof(text) / sizeof(text[0]) - length, L"bodies drawn %u culled %u\n", counters[PROFILE_BODIES_DRAWN], counters[PROFILE_BODIES_CULLED]);
+	length += swprintf(text + length, sizeof(text) / sizeof(text[0]) - length, L"trails drawn %u culled %u\n", counters[PROFILE_TRAILS_DRAWN], counters[PROFILE_TRAILS_CULLED]);
+	length += swprintf(text + length, sizeof(text) / sizeof(text[0]) - length, L"labels drawn %u hidden %u\n", counters[PROFILE_LABELS_DRAWN], counters[PROFILE_LABELS_HIDDEN]);
+	overlay->setText(text);
+}
@@ -0,0 +1,53 @@
+#pragma once
+#include <irrlicht.h>
+#include <cstdio>
+using namespace irr;
+using namespace core;
+
+enum ProfilePhase { PROFILE_PHYSICS, PROFILE_COLLISIONS, PROFILE_TRAILS, PROFILE_PREPARE_DRAW, PROFILE_DRAW_ALL, PROFILE_END_SCENE, PROFILE_PHASE_COUNT };
+enum ProfileCounter { PROFILE_BODIES_DRAWN, PROFILE_BODIES_CULLED, PROFILE_TRAILS_DRAWN, PROFILE_TRAILS_CULLED, PROFILE_LABELS_DRAWN, PROFILE_LABELS_HIDDEN, PROFILE_COUNTER_COUNT };
+
+//Frames kept per phase for the rolling percentiles.
+const u32 PROFILE_HISTORY = 256;
+
+//Per frame phase timings with a high resolution timer. Everything is preallocated, so measuring,
+//the percentiles and the CSV dump do not allocate per frame.
+class Profiler
+{
+public:
+	Profiler();
+	~Profiler();
+
+	void begin(u32 phase);
+	void end(u32 phase);
+	void endFrame();
+
+	//Latest value of a per frame count, shown and logged as is.
+	void count(u32 counter, u32 value);
+
+	//Milliseconds below which the given fraction of the recorded frames fall.
+	f64 percentile(u32 phase, f64 fraction);
+
+	bool openCsv(const io::path& fileName);
+	void createOverlay(gui::IGUIEnvironment* guienv, const rect<s32>& area);
+
+	//Rewrites the overlay text. Caller decides how often, setText() copies the string.
+	void updateOverlay(f64 fps);
+
+private:
+	u64 now() const;
+
+	f64 secondsPerTick;
+	u64 started[PROFILE_PHASE_COUNT];
+	f64 frame[PROFILE_PHASE_COUNT];
+	u32 counters[PROFILE_COUNTER_COUNT];
+	f64 history[PROFILE_PHASE_COUNT][PROFILE_HISTORY];
+	f64 scratch[PROFILE_HISTORY];
+	u32 historyHead;
+	u32 historyCount;
+	u32 frameNumber;
+
+	FILE* csv;
+	gui::IGUIStaticText* overlay;
+	wchar_t text[1024];
+};
@@ -0,0 +1,159 @@
+#include "RenderFrame.h"
+#include <cmath>
+
+//Scaled distance over true distance for a distance in units of the scaling radius. Both curves have slope 1
+//at the Sun, so the factor approaches distanceScale there; the lower bound only keeps the Sun itself from dividing by 0.
+static inline double logFactor(double distance)
+{
+	distance = distance > 1e-30 ? distance : 1e-30;
+	return log(1 + distance) / distance;
+}
+
+static inline double asinhFactor(double distance)
+{
+	distance = distance > 1e-30 ? distance : 1e-30;
+	return log(distance + sqrt(distance * distance + 1)) / distance;
+}
+
+RenderFrame::RenderFrame(double distanceScale)
+{
+	this->distanceScale = distanceScale;
+	scaling = SCALE_LINEAR;
+	scalingRadius = 1;
+	origin = vector3d<double>(0);
+	interpolation = 1;
+	stepDuration = 0;
+}
+
+void RenderFrame::recenter(scene::ICameraSceneNode* camera)
+{
+	vector3df offset = camera->getPosition();
+	origin += vector3d<double>(offset.X, offset.Y, offset.Z);
+
+	vector3df target = camera->getTarget();
+	camera->setPosition(vector3df(0));
+	camera->setTarget(target - offset);
+	camera->updateAbsolutePosition();
+}
+
+void RenderFrame::setScaling(int scaling, double scalingRadius)
+{
+	this->scaling = scaling;
+	this->scalingRadius = scalingRadius;
+}
+
+void RenderFrame::setInterpolation(double interpolation, double stepDuration)
+{
+	this->interpolation = core::clamp(interpolation, 0.0, 1.0);
+	this->stepDuration = stepDuration;
+}
+
+vector3d<double> RenderFrame::interpolate(const vector3d<double>& previousPosition, const vector3d<double>& previousVelocity, const vector3d<double>& position, const vector3d<double>& velocity) const
+{
+	if (interpolation >= 1)
+	{
+		return position;
+	}
+
+	//Cubic Hermite spline through both states, so the drawn path follows the orbit's curvature.
+	double t = interpolation;
+	double t2 = t * t;
+	double t3 = t2 * t;
+	double h00 = 2 * t3 - 3 * t2 + 1;
+	double h10 = t3 - 2 * t2 + t;
+	double h01 = -2 * t3 + 3 * t2;
+	double h11 = t3 - t2;
+
+	return previousPosition * h00 + previousVelocity * (h10 * stepDuration) + position * h01 + velocity * (h11 * stepDuration);
+}
+
+vector3d<double> RenderFrame::drawPosition(const Body* body) const
+{
+	return interpolate(body->previousPosition, body->previousVelocity, body->position, body->velocity);
+}
+
+vector3d<double> RenderFrame::toScaled(const vector3d<double>& position) const
+{
+	if (scaling == SCALE_LINEAR)
+	{
+		return position * distanceScale;
+	}
+
+	double distance = position.getLength() / scalingRadius;
+	return position * (distanceScale * (scaling == SCALE_LOG ? logFactor(distance) : asinhFactor(distance)));
+}
+
+vector3df RenderFrame::toRender(const vector3d<double>& position) const
+{
+	return scaledToRender(toScaled(position));
+}
+
+vector3df RenderFrame::scaledToRender(const vector3d<double>& scaled) const
+{
+	return vector3df((f32)(scaled.X - origin.X), (f32)(scaled.Y - origin.Y), (f32)(scaled.Z - origin.Z));
+}
+
+void RenderFrame::scaleFactors(const double* x, const double* y, const double* z, u32 count, double* factors) const
+{
+	double inverseRadius = 1 / scalingRadius;
+
+	//The mode is chosen outside the loops, so each loop body is straight line code.
+	if (scaling == SCALE_LINEAR)
+	{
+		for (u32 i = 0; i < count; i++)
+		{
+			factors[i] = distanceScale;
+		}
+	}
+	else if (scaling == SCALE_LOG)
+	{
+		for (u32 i = 0; i < count; i++)
+		{
+			factors[i] = distanceScale * logFactor(sqrt(x[i] * x[i] + y[i] * y[i] + z[i] * z[i]) * inverseRadius);
+		}
+	}
+	else
+	{
+		for (u32 i = 0; i < count; i++)
+		{
+			factors[i] = distanceScale * asinhFactor(sqrt(x[i] * x[i] + y[i] * y[i] + z[i] * z[i]) * inverseRadius);
+		}
+	}
+}
+
+void RenderFrame::toRender(const double* x, const double* y, const double* z, u32 count, video::S3DVertex* vertices) const
+{
+	//Factors are computed a block at a time, so they stay in the cache and need no allocation.
+	const u32 BLOCK_SIZE = 256;
+	double factors[BLOCK_SIZE];
+
+	for (u32 first = 0; first < count; first += BLOCK_SIZE)
+	{
+		u32 block = core::min_(BLOCK_SIZE, count - first);
+		scaleFactors(x + first, y + first, z + first, block, factors);
+
+		for (u32 i = 0; i < block; i++)
+		{
+			video::S3DVertex& vertex = vertices[first + i];
+			vertex.Pos.X = (f32)(x[first + i] * factors[i] - origin.X);
+			vertex.Pos.Y = (f32)(y[first + i] * factors[i] - origin.Y);
+			vertex.Pos.Z = (f32)(z[first + i] * factors[i] - origin.Z);
+		}
+	}
+}
+
+void RenderFrame::toRender(const double* x, const double* y, const double* z, u32 count, const vector3d<double>& center, double localScale, video::S3DVertex* vertices) const
+{
+	double scale = distanceScale * localScale;
+	vector3d<double> scaledCenter = toScaled(center);
+	double offsetX = scaledCenter.X - origin.X;
+	double offsetY = scaledCenter.Y - origin.Y;
+	double offsetZ = scaledCenter.Z - origin.Z;
+
+	for (u32 i = 0; i < count; i++)
+	{
+		vertices[i].Pos.X = (f32)(x[i] * scale + offsetX);
+		vertices[i].Pos.Y = (f32)(y[i] * scale + offsetY);
+		vertices[i].Pos.Z = (f32)(z[i] * scale + offsetZ);
+	}
+}
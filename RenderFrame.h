@@ -0,0 +1,52 @@
+#pragma once
+#include <irrlicht.h>
+#include "Body.h"
+using namespace irr;
+using namespace core;
+
+//How distances from the Sun are mapped to the screen. The nonlinear modes stay close to linear below
+//the scaling radius and compress distances beyond it, so the outer planets fit on screen next to the inner ones.
+enum DistanceScaling { SCALE_LINEAR, SCALE_LOG, SCALE_ASINH };
+
+//Maps simulation positions (metres, double) to positions handed to Irrlicht (draw units, float).
+//The render origin follows the camera, and positions are made relative to it in double precision
+//before the conversion to float, so nothing drawn near the camera loses precision to its distance from the Sun.
+class RenderFrame
+{
+public:
+	RenderFrame(double distanceScale);
+
+	void setScaling(int scaling, double scalingRadius);
+
+	//Moves the render origin to the camera and the camera back to the render origin.
+	void recenter(scene::ICameraSceneNode* camera);
+
+	//Where between the previous and the latest physics state this frame is drawn, from 0 to 1,
+	//and how much simulated time separates the two states.
+	void setInterpolation(double interpolation, double stepDuration);
+	vector3d<double> interpolate(const vector3d<double>& previousPosition, const vector3d<double>& previousVelocity, const vector3d<double>& position, const vector3d<double>& velocity) const;
+	//Reads the body's live state, so it must not be called while an update is still stepping the bodies.
+	vector3d<double> drawPosition(const Body* body) const;
+
+	vector3d<double> toScaled(const vector3d<double>& position) const;
+	vector3df toRender(const vector3d<double>& position) const;
+	vector3df scaledToRender(const vector3d<double>& scaled) const;
+
+	//Factors that scale each position to its scaled position, for many positions at once.
+	//Plain loops over separate coordinate arrays with no branches, so the compiler can vectorize them.
+	void scaleFactors(const double* x, const double* y, const double* z, u32 count, double* factors) const;
+
+	//Converts positions relative to the Sun into vertex positions.
+	void toRender(const double* x, const double* y, const double* z, u32 count, video::S3DVertex* vertices) const;
+
+	//Converts positions relative to center, stretched by localScale on screen, into vertex positions.
+	//Only center is scaled nonlinearly, the relative positions keep the linear scale, the same as the body spheres.
+	void toRender(const double* x, const double* y, const double* z, u32 count, const vector3d<double>& center, double localScale, video::S3DVertex* vertices) const;
+
+	double distanceScale;
+	int scaling;
+	double scalingRadius;
+	vector3d<double> origin; //Absolute position of the render origin in draw units.
+	double interpolation;
+	double stepDuration;
+};
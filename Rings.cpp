@@ -0,0 +1,204 @@
+#include "Rings.h"
+#include "Simulation.h"
+#include <cmath>
+#include <random>
+
+array<RingSpec> createRingSpecs()
+{
+	array<RingSpec> specs;
+
+	//Poles from the IAU rotational elements, rotated into the ecliptic frame of createBodies().
+	RingSpec saturn;
+	saturn.planet = "Saturn";
+	saturn.texturePath = "resources/planet_textures/texture_saturn_ring.png";
+	saturn.innerRadius = 74.5e6;
+	saturn.outerRadius = 140.22e6;
+	saturn.pole = vector3d<double>(0.0854788, 0.4624417, 0.8825197);
+	saturn.j2 = 16290.7e-6;
+	saturn.equatorialRadius = 60.268e6;
+	specs.push_back(saturn);
+
+	RingSpec uranus;
+	uranus.planet = "Uranus";
+	uranus.texturePath = "resources/planet_textures/texture_uranus_ring.png";
+	uranus.innerRadius = 38e6;
+	uranus.outerRadius = 51.149e6;
+	uranus.pole = vector3d<double>(-0.2119996, -0.9679890, 0.1343632);
+	uranus.j2 = 3510.7e-6;
+	uranus.equatorialRadius = 25.559e6;
+	specs.push_back(uranus);
+
+	return specs;
+}
+
+//Flat annulus around the origin in units of the planet radius, u running from the inner to the outer edge.
+static scene::IMesh* createRingMesh(const RingSpec& spec, double planetRadius, u32 segments)
+{
+	vector3d<double> pole = spec.pole;
+	pole.normalize();
+	vector3d<double> u = fabs(pole.Z) < 0.9 ? pole.crossProduct(vector3d<double>(0, 0, 1)) : pole.crossProduct(vector3d<double>(1, 0, 0));
+	u.normalize();
+	vector3d<double> w = pole.crossProduct(u);
+
+	f32 inner = (f32)(spec.innerRadius / planetRadius);
+	f32 outer = (f32)(spec.outerRadius / planetRadius);
+	vector3df normal((f32)pole.X, (f32)pole.Y, (f32)pole.Z);
+
+	scene::SMeshBuffer* buffer = new scene::SMeshBuffer();
+	for (u32 i = 0; i <= segments; i++)
+	{
+		double angle = 2 * PI64 * i / segments;
+		vector3d<double> direction = u * cos(angle) + w * sin(angle);
+		vector3df d((f32)direction.X, (f32)direction.Y, (f32)direction.Z);
+		buffer->Vertices.push_back(video::S3DVertex(d * inner, normal, video::SColor(255, 255, 255, 255), vector2df(0, 0.5f)));
+		buffer->Vertices.push_back(video::S3DVertex(d * outer, normal, video::SColor(255, 255, 255, 255), vector2df(1, 0.5f)));
+	}
+	for (u32 i = 0; i < segments; i++)
+	{
+		u16 first = (u16)(i * 2);
+		buffer->Indices.push_back(first);
+		buffer->Indices.push_back(first + 1);
+		buffer->Indices.push_back(first + 3);
+		buffer->Indices.push_back(first);
+		buffer->Indices.push_back(first + 3);
+		buffer->Indices.push_back(first + 2);
+	}
+	buffer->recalculateBoundingBox();
+	buffer->setHardwareMappingHint(scene::EHM_STATIC);
+
+	scene::SMesh* mesh = new scene::SMesh();
+	mesh->addMeshBuffer(buffer);
+	buffer->drop();
+	mesh->recalculateBoundingBox();
+	return mesh;
+}
+
+PlanetRings::PlanetRings(const RingSpec& spec, Body* planet, int mode, u32 particleCount, f32 particleSize, const RenderFrame* frame, IrrlichtDevice* device, TextureLoader* textures)
+{
+	this->planet = planet;
+	ringNode = 0;
+	particleNode = 0;
+	backlog = 0;
+
+	scene::ISceneManager* smgr = device->getSceneManager();
+
+	if (mode == RINGS_TEXTURED && planet->visual->sphere)
+	{
+		//A child of the sphere, so it follows the planet and its draw scale and is culled with it, out to the ring's edge.
+		scene::IMesh* mesh = createRingMesh(spec, planet->radius, 128);
+		ringNode = smgr->addMeshSceneNode(mesh, planet->visual->sphere);
+		mesh->drop();
+		ringNode->grab();
+		planet->visual->extent = core::max_(planet->visual->extent, (f32)(spec.outerRadius / planet->radius));
+
+		video::SMaterial& material = ringNode->getMaterial(0);
+		material.Lighting = false;
+		material.BackfaceCulling = false;
+		material.MaterialType = video::EMT_TRANSPARENT_ALPHA_CHANNEL;
+		//Loaded right away, the strip is small. The loader's lock keeps it from decoding alongside the loader threads.
+		material.setTexture(0, textures ? textures->getTexture(spec.texturePath) : device->getVideoDriver()->getTexture(spec.texturePath));
+	}
+	else if (mode == RINGS_PARTICLES)
+	{
+		particles.setOblateness(spec.j2, spec.equatorialRadius, spec.pole);
+		populateRing(particles, spec, planet->mass, particleCount, 3);
+
+		particleNode = new ParticleSceneNode(smgr->getRootSceneNode(), smgr, &particles, frame, particleSize, video::SColor(255, 210, 195, 170));
+	}
+}
+
+PlanetRings::~PlanetRings()
+{
+	//Nodes are held, so they stay valid even when the planet's sphere was removed first.
+	if (ringNode)
+	{
+		ringNode->remove();
+		ringNode->drop();
+	}
+	if (particleNode)
+	{
+		particleNode->remove();
+		particleNode->drop();
+	}
+}
+
+void PlanetRings::step(double timeStep, double maxStep, u32 maxSteps)
+{
+	if (particles.size() == 0)
+	{
+		return;
+	}
+
+	//Less than a step stays in the backlog until enough time has built up.
+	backlog += timeStep;
+	u32 steps = core::min_((u32)(backlog / maxStep), maxSteps);
+	for (u32 i = 0; i < steps; i++)
+	{
+		particles.step(planet->mass, maxStep);
+	}
+	backlog -= steps * maxStep;
+
+	//Owing more than a call can make up would keep the rings racing long after the warp drops, so the rest is dropped.
+	backlog = core::min_(backlog, maxSteps * maxStep);
+}
+
+void PlanetRings::prepareDraw(const RenderFrame& frame)
+{
+	//Same stretch as the planet's sphere, so the rings keep their size relative to it.
+	if (particleNode)
+	{
+		particleNode->setVisible(!planet->removed);
+		particleNode->setFrame(frame.drawPosition(planet), planet->visual->drawRadius / planet->radius);
+	}
+}
+
+array<PlanetRings*> createRings(const array<Body*>& bodies, int mode, u32 particleCount, f32 particleSize, const RenderFrame* frame, IrrlichtDevice* device, TextureLoader* textures)
+{
+	array<PlanetRings*> rings;
+	if (mode == RINGS_OFF)
+	{
+		return rings;
+	}
+
+	array<RingSpec> specs = createRingSpecs();
+	for (u32 i = 0; i < specs.size(); i++)
+	{
+		for (u32 j = 0; j < bodies.size(); j++)
+		{
+			if (bodies[j]->name == specs[i].planet && bodies[j]->visual)
+			{
+				rings.push_back(new PlanetRings(specs[i], bodies[j], mode, particleCount, particleSize, frame, device, textures));
+				break;
+			}
+		}
+	}
+	return rings;
+}
+
+void populateRing(TestParticles& particles, const RingSpec& spec, double centralMass, u32 count, u32 seed)
+{
+	vector3d<double> pole = spec.pole;
+	pole.normalize();
+	vector3d<double> u = fabs(pole.Z) < 0.9 ? pole.crossProduct(vector3d<double>(0, 0, 1)) : pole.crossProduct(vector3d<double>(1, 0, 0));
+	u.normalize();
+	vector3d<double> w = pole.crossProduct(u);
+
+	std::mt19937 generator(seed);
+	std::uniform_real_distribution<double> radius(spec.innerRadius, spec.outerRadius);
+	std::uniform_real_distribution<double> angle(0, 2 * PI64);
+	std::normal_distribution<double> height(0, 10); //Main rings are only tens of metres thick.
+
+	double mu = G * centralMass;
+	for (u32 i = 0; i < count; i++)
+	{
+		double r = radius(generator);
+		double phase = angle(generator);
+		vector3d<double> direction = u * cos(phase) + w * sin(phase);
+		vector3d<double> along = w * cos(phase) - u * sin(phase);
+
+		//Circular speed in the equatorial plane includes the extra pull of the equatorial bulge.
+		double bulge = spec.equatorialRadius / r;
+		double speed = sqrt(mu / r * (1 + 1.5 * spec.j2 * bulge * bulge));
+		particles.add(direction * r + pole * height(generator), along * speed);
+	}
+}
@@ -0,0 +1,53 @@
+#pragma once
+#include <irrlicht.h>
+#include "BodyVisual.h"
+#include "ParticleSceneNode.h"
+#include "RenderFrame.h"
+#include "TestParticles.h"
+#include "TextureLoader.h"
+using namespace irr;
+using namespace core;
+
+enum RingMode { RINGS_OFF, RINGS_TEXTURED, RINGS_PARTICLES };
+
+//A planet's ring system, in metres around the planet.
+struct RingSpec
+{
+	stringw planet;
+	io::path texturePath; //Radial strip, inner edge at the left.
+	double innerRadius;
+	double outerRadius;
+	vector3d<double> pole; //Spin axis in the simulation frame.
+	double j2;
+	double equatorialRadius; //Reference radius of j2.
+};
+
+array<RingSpec> createRingSpecs();
+
+//Rings of one planet, either as a textured annulus attached to the planet's sphere, or as test particles
+//orbiting in the planet's frame under its oblate field. The particles never feel the Sun or each other,
+//so tens of thousands of them cost no more than the planet's own orbit does in a global N-body.
+class PlanetRings
+{
+public:
+	PlanetRings(const RingSpec& spec, Body* planet, int mode, u32 particleCount, f32 particleSize, const RenderFrame* frame, IrrlichtDevice* device, TextureLoader* textures);
+	~PlanetRings();
+
+	//Advances the particles by timeStep in steps of maxStep, at most maxSteps of them per call. Less than a step is
+	//carried over to later calls, but time beyond one call's worth of steps is dropped, so at high warp the rings
+	//simply turn slower than the planet instead of owing time they would later race through. Longer steps would keep
+	//up but break the rings apart.
+	void step(double timeStep, double maxStep, u32 maxSteps);
+	void prepareDraw(const RenderFrame& frame);
+
+	Body* planet;
+
+private:
+	scene::IMeshSceneNode* ringNode;
+	TestParticles particles;
+	double backlog; //Simulated time the particles are behind, at most one call's worth of steps.
+	ParticleSceneNode* particleNode;
+};
+
+array<PlanetRings*> createRings(const array<Body*>& bodies, int mode, u32 particleCount, f32 particleSize, const RenderFrame* frame, IrrlichtDevice* device, TextureLoader* textures);
+void populateRing(TestParticles& particles, const RingSpec& spec, double centralMass, u32 count, u32 seed);
@@ -0,0 +1,179 @@
+#include "Simulation.h"
+
+void integrate(Body* body1, Body* body2, double timeStep, int integrationMethod)
+{
+	vector3d<double> acceleration;
+	if (integrationMethod == EULER) {
+		acceleration = ((-G * body1->mass * body2->mass * body2->position) / pow(body2->position.getLength(), 3)) / body2->mass;
+		body2->position += body2->velocity * timeStep;
+		body2->velocity += acceleration * timeStep;
+	}
+
+	else if (integrationMethod == LEAPFROG) {
+		acceleration = ((-G * body1->mass * body2->mass * body2->position) / pow(body2->position.getLength(), 3)) / body2->mass;
+		body2->position += (body2->velocity * timeStep) + 0.5 * acceleration * pow(timeStep, 2);
+		vector3d<double> nextAcceleration = ((-G * body1->mass * body2->mass * body2->position) / pow(body2->position.getLength(), 3)) / body2->mass;
+		body2->velocity += 0.5 * (acceleration + nextAcceleration) * timeStep;
+	}
+
+	else if (integrationMethod == RK4) {
+		vector3d<double> pos1 = body2->position;
+		vector3d<double> acceleration1 = ((-G * body1->mass * body2->mass * pos1) / pow(pos1.getLength(), 3)) / body2->mass;
+		vector3d<double> velocity1 = body2->velocity;
+
+		vector3d<double> pos2 = pos1 + timeStep * velocity1 * 0.5;
+		vector3d<double> acceleration2 = ((-G * body1->mass * body2->mass * pos2) / pow(pos2.getLength(), 3)) / body2->mass;
+		vector3d<double> velocity2 = body2->velocity + timeStep * acceleration1 * 0.5;
+
+		vector3d<double> pos3 = pos1 + timeStep * velocity2 * 0.5;
+		vector3d<double> acceleration3 = ((-G * body1->mass * body2->mass * pos3) / pow(pos3.getLength(), 3)) / body2->mass;
+		vector3d<double> velocity3 = body2->velocity + timeStep * acceleration2 * 0.5;
+
+		vector3d<double> pos4 = pos1 + timeStep * velocity3;
+		vector3d<double> acceleration4 = ((-G * body1->mass * body2->mass * pos4) / pow(pos4.getLength(), 3)) / body2->mass;
+		vector3d<double> velocity4 = body2->velocity + timeStep * acceleration3;
+
+		body2->position += timeStep * (velocity1 + 2 * velocity2 + 2 * velocity3 + velocity4) / 6;
+		body2->velocity += timeStep * (acceleration1 + 2 * acceleration2 + 2 * acceleration3 + acceleration4) / 6;
+	}
+}
+
+array<Body*> createBodies()
+{
+	array<Body*> bodies;
+
+	//Data from A.D. 2000-Jan-01 00:00:00.0000 CT
+
+	bodies.push_back(
+		new Body(
+		"Sol",
+		vector3d<double>(0),
+		vector3d<double>(0),
+		6.955e8,
+		1.988544e30,
+		"resources/planet_textures/texture_sun.jpg"
+		));
+
+	bodies.push_back(
+		new Body(
+		"Mercury",
+		vector3d<double>(-2.105262111032039E+10, -6.640663808353403E+10, -3.492446023382954E+09),
+		vector3d<double>(3.665298706393840E+04, -1.228983810111077E+04, -4.368172898981951E+03),
+		2440000,
+		3.302e23,
+		"resources/planet_textures/texture_mercury.jpg"
+		));
+
+	bodies.push_back(
+		new Body(
+		"Venus",
+		vector3d<double>(-1.075055502695123E+11, -3.366520720591562E+09, 6.159219802771119E+09),
+		vector3d<double>(8.891598046362434E+02, -3.515920774124290E+04, -5.318594054684045E+02),
+		6051800,
+		48.685e23,
+		"resources/planet_textures/texture_venus_atmosphere.jpg"
+		));
+
+	bodies.push_back(
+		new Body(
+		"Earth",
+		vector3d<double>(-2.521092863852298E+10, 1.449279195712076E+11, -6.164888475164771E+05),
+		vector3d<double>(-2.983983333368269E+04, -5.207633918704476E+03, 6.169062303484907E-02),
+		6371010,
+		5.97219e24,
+		"resources/planet_textures/texture_earth_surface.jpg"
+		));
+
+	bodies.push_back(
+		new Body(
+		"Mars",
+		vector3d<double>(2.079950549908331E+11, -3.143009561106971E+09, -5.178781160069674E+09),
+		vector3d<double>(1.295003532851602E+03, 2.629442067068712E+04, 5.190097267545717E+02),
+		3389900,
+		6.4185e23,
+		"resources/planet_textures/texture_mars.jpg"
+		));
+
+	bodies.push_back(
+		new Body(
+		"Jupiter",
+		vector3d<double>(5.989091594973032E+11, 4.391225931530510E+11, -1.523254614945272E+10),
+		vector3d<double>(-7.901937610713569E+03, 1.116317695450082E+04, 1.306729070868444E+02),
+		69911000,
+		1898.13e24,
+		"resources/planet_textures/texture_jupiter.jpg"
+		));
+
+	bodies.push_back(
+		new Body(
+		"Saturn",
+		vector3d<double>(9.587063368200246E+11, 9.825652109121954E+11, -5.522065682385063E+10),
+		vector3d<double>(-7.428885683466339E+03, 6.738814237717373E+03, 1.776643613880609E+02),
+		58232000,
+		5.68319e26,
+		"resources/planet_textures/texture_saturn.jpg"
+		));
+
+	bodies.push_back(
+		new Body(
+		"Uranus",
+		vector3d<double>(2.158774703477132E+12, -2.054825231595053E+12, -3.562348723541665E+10),
+		vector3d<double>(4.637648411798584E+03, 4.627192877193528E+03, -4.285025663198061E+01),
+		25362000,
+		86.8103e24,
+		"resources/planet_textures/texture_uranus.jpg"
+		));
+
+	bodies.push_back(
+		new Body(
+		"Neptune",
+		vector3d<double>(2.514853420151505E+12, -3.738847412364252E+12, 1.903947325211763E+10),
+		vector3d<double>(4.465799984073191E+03, 3.075681163952201E+03, -1.665654118310400E+02),
+		24624000,
+		102.41e24,
+		"resources/planet_textures/texture_neptune.jpg"
+		));
+
+	return bodies;
+}
+
+void randomCircularOrbit(std::mt19937& generator, double centralMass, double minRadius, double maxRadius, double inclinationSpread, vector3d<double>& position, vector3d<double>& velocity)
+{
+	std::uniform_real_distribution<double> semiMajorAxis(minRadius, maxRadius);
+	std::uniform_real_distribution<double> angle(0, 2 * PI64);
+	std::normal_distribution<double> inclination(0, inclinationSpread);
+
+	//A circular orbit in a plane tilted about a random line of nodes.
+	double radius = semiMajorAxis(generator);
+	double node = angle(generator);
+	double phase = angle(generator);
+	double tilt = inclination(generator);
+	double speed = sqrt(G * centralMass / radius);
+
+	vector3d<double> nodeDirection(cos(node), sin(node), 0);
+	vector3d<double> inPlane(-sin(node) * cos(tilt), cos(node) * cos(tilt), sin(tilt));
+	position = (nodeDirection * cos(phase) + inPlane * sin(phase)) * radius;
+	velocity = (inPlane * cos(phase) - nodeDirection * sin(phase)) * speed;
+}
+
+array<Body*> createAsteroidBelt(const Body* sun, u32 count, u32 seed)
+{
+	array<Body*> asteroids;
+	asteroids.reallocate(count);
+
+	std::mt19937 generator(seed);
+	for (u32 i = 0; i < count; i++)
+	{
+		vector3d<double> position;
+		vector3d<double> velocity;
+		randomCircularOrbit(generator, sun->mass, 3.1e11, 4.9e11, 8 * DEGTORAD64, position, velocity); //2.1 - 3.3 AU
+
+		stringw name = L"Asteroid ";
+		name += i;
+
+		//Headless bodies, they get no visual and are drawn together by a BodyBatchSceneNode.
+		asteroids.push_back(new Body(name, position, velocity, 5e4, 1e15, ""));
+	}
+
+	return asteroids;
+}
\ No newline at end of file
@@ -0,0 +1,14 @@
+#pragma once
+#include <random>
+#include "Body.h"
+using namespace irr;
+using namespace core;
+
+#define G 6.6743e-11
+
+enum IntegrationMethod { EULER, LEAPFROG, RK4 };
+
+void integrate(Body*, Body*, double, int);
+array<Body*> createBodies();
+void randomCircularOrbit(std::mt19937&, double, double, double, double, vector3d<double>&, vector3d<double>&);
+array<Body*> createAsteroidBelt(const Body*, u32, u32);
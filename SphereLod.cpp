@@ -0,0 +1,56 @@
+#include "SphereLod.h"
+#include <cmath>
+
+SphereLod::SphereLod(scene::ISceneManager* smgr)
+{
+	const u32 segments[] = { 8, 16, 32, 64, 128 };
+	const f32 pixels[] = { 4, 16, 48, 128, FLT_MAX };
+
+	for (u32 i = 0; i < 5; i++)
+	{
+		meshes.push_back(smgr->getGeometryCreator()->createSphereMesh(1, segments[i], segments[i]));
+		maxPixelRadius.push_back(pixels[i]);
+	}
+}
+
+SphereLod::~SphereLod()
+{
+	for (u32 i = 0; i < meshes.size(); i++)
+	{
+		meshes[i]->drop();
+	}
+}
+
+scene::IMesh* SphereLod::getMesh(u32 level) const
+{
+	return meshes[core::min_(level, meshes.size() - 1)];
+}
+
+void SphereLod::update(const array<Body*>& bodies, scene::ICameraSceneNode* camera, u32 screenHeight)
+{
+	vector3df cameraPosition = camera->getPosition();
+	f32 pixelsPerUnit = screenHeight * 0.5f / tanf(camera->getFOV() * 0.5f);
+
+	for (u32 i = 0; i < bodies.size(); i++)
+	{
+		BodyVisual* visual = bodies[i]->visual;
+		if (!visual || !visual->sphere || !visual->sphere->isVisible())
+		{
+			continue;
+		}
+
+		f32 distance = core::max_(visual->sphere->getPosition().getDistanceFrom(cameraPosition), 1e-3f);
+		f32 pixelRadius = (f32)visual->drawRadius / distance * pixelsPerUnit;
+
+		u32 level = 0;
+		while (level + 1 < meshes.size() && pixelRadius > maxPixelRadius[level])
+		{
+			level++;
+		}
+
+		if (level != visual->lodLevel || visual->sphere->getMesh() != meshes[level])
+		{
+			visual->setLodMesh(meshes[level], level);
+		}
+	}
+}
@@ -0,0 +1,21 @@
+#pragma once
+#include <irrlicht.h>
+#include "BodyVisual.h"
+using namespace irr;
+using namespace core;
+
+//Shared unit sphere meshes of increasing detail. Each frame every body is given the coarsest mesh
+//that still looks round at its projected size on screen.
+class SphereLod
+{
+public:
+	SphereLod(scene::ISceneManager* smgr);
+	~SphereLod();
+
+	void update(const array<Body*>& bodies, scene::ICameraSceneNode* camera, u32 screenHeight);
+	scene::IMesh* getMesh(u32 level) const;
+
+private:
+	array<scene::IMesh*> meshes;
+	array<f32> maxPixelRadius; //Largest projected radius in pixels each level is used for.
+};
@@ -0,0 +1,181 @@
+#include "TestParticles.h"
+#include "Simulation.h"
+#include <cmath>
+
+//Point mass plus J2 acceleration, written out so the particle loops vectorize.
+static inline void oblateAcceleration(double x, double y, double z, double mu, double j2R2, double poleX, double poleY, double poleZ, double& ax, double& ay, double& az)
+{
+	double r2 = x * x + y * y + z * z;
+	double inverseR2 = 1 / r2;
+	double inverseR3 = inverseR2 / sqrt(r2);
+	double s = x * poleX + y * poleY + z * poleZ;
+	double k = 1.5 * j2R2 * inverseR2;
+	double radial = -mu * inverseR3 * (1 - k * (5 * s * s * inverseR2 - 1));
+	double axial = -mu * inverseR3 * 2 * k * s;
+	ax = x * radial + poleX * axial;
+	ay = y * radial + poleY * axial;
+	az = z * radial + poleZ * axial;
+}
+
+TestParticles::TestParticles()
+{
+	accelerationMass = 0;
+	j2 = 0;
+	equatorialRadius = 0;
+	pole = vector3d<double>(0, 0, 1);
+}
+
+void TestParticles::setOblateness(double j2, double equatorialRadius, const vector3d<double>& pole)
+{
+	this->j2 = j2;
+	this->equatorialRadius = equatorialRadius;
+	this->pole = pole;
+	this->pole.normalize();
+	accelerationMass = 0;
+}
+
+void TestParticles::add(const vector3d<double>& position, const vector3d<double>& velocity)
+{
+	x.push_back(position.X);
+	y.push_back(position.Y);
+	z.push_back(position.Z);
+	vx.push_back(velocity.X);
+	vy.push_back(velocity.Y);
+	vz.push_back(velocity.Z);
+	accelerationMass = 0;
+}
+
+void TestParticles::clear()
+{
+	x.clear();
+	y.clear();
+	z.clear();
+	vx.clear();
+	vy.clear();
+	vz.clear();
+	accelerationMass = 0;
+}
+
+u32 TestParticles::size() const
+{
+	return x.size();
+}
+
+void TestParticles::computeAccelerations(double centralMass)
+{
+	u32 count = size();
+	ax.resize(count);
+	ay.resize(count);
+	az.resize(count);
+
+	double mu = G * centralMass;
+	double j2R2 = j2 * equatorialRadius * equatorialRadius;
+	for (u32 i = 0; i < count; i++)
+	{
+		oblateAcceleration(x[i], y[i], z[i], mu, j2R2, pole.X, pole.Y, pole.Z, ax[i], ay[i], az[i]);
+	}
+
+	accelerationMass = centralMass;
+}
+
+void TestParticles::step(double centralMass, double timeStep)
+{
+	//The acceleration at the end of a step is reused at the start of the next one.
+	if (accelerationMass != centralMass)
+	{
+		computeAccelerations(centralMass);
+	}
+
+	if (j2 != 0)
+	{
+		stepOblate(centralMass, timeStep);
+		return;
+	}
+
+	double mu = G * centralMass;
+	double halfStepSquared = 0.5 * timeStep * timeStep;
+	double halfStep = 0.5 * timeStep;
+	u32 count = size();
+
+	double* px = x.data();
+	double* py = y.data();
+	double* pz = z.data();
+	double* pvx = vx.data();
+	double* pvy = vy.data();
+	double* pvz = vz.data();
+	double* pax = ax.data();
+	double* pay = ay.data();
+	double* paz = az.data();
+
+	for (u32 i = 0; i < count; i++)
+	{
+		px[i] += pvx[i] * timeStep + pax[i] * halfStepSquared;
+		py[i] += pvy[i] * timeStep + pay[i] * halfStepSquared;
+		pz[i] += pvz[i] * timeStep + paz[i] * halfStepSquared;
+
+		double r2 = px[i] * px[i] + py[i] * py[i] + pz[i] * pz[i];
+		double factor = -mu / (r2 * sqrt(r2));
+		double newAx = px[i] * factor;
+		double newAy = py[i] * factor;
+		double newAz = pz[i] * factor;
+
+		pvx[i] += (pax[i] + newAx) * halfStep;
+		pvy[i] += (pay[i] + newAy) * halfStep;
+		pvz[i] += (paz[i] + newAz) * halfStep;
+		pax[i] = newAx;
+		pay[i] = newAy;
+		paz[i] = newAz;
+	}
+}
+
+//Same step as step(), with the J2 term in the acceleration.
+void TestParticles::stepOblate(double centralMass, double timeStep)
+{
+	double mu = G * centralMass;
+	double j2R2 = j2 * equatorialRadius * equatorialRadius;
+	double poleX = pole.X;
+	double poleY = pole.Y;
+	double poleZ = pole.Z;
+	double halfStepSquared = 0.5 * timeStep * timeStep;
+	double halfStep = 0.5 * timeStep;
+	u32 count = size();
+
+	double* px = x.data();
+	double* py = y.data();
+	double* pz = z.data();
+	double* pvx = vx.data();
+	double* pvy = vy.data();
+	double* pvz = vz.data();
+	double* pax = ax.data();
+	double* pay = ay.data();
+	double* paz = az.data();
+
+	for (u32 i = 0; i < count; i++)
+	{
+		px[i] += pvx[i] * timeStep + pax[i] * halfStepSquared;
+		py[i] += pvy[i] * timeStep + pay[i] * halfStepSquared;
+		pz[i] += pvz[i] * timeStep + paz[i] * halfStepSquared;
+
+		double newAx, newAy, newAz;
+		oblateAcceleration(px[i], py[i], pz[i], mu, j2R2, poleX, poleY, poleZ, newAx, newAy, newAz);
+
+		pvx[i] += (pax[i] + newAx) * halfStep;
+		pvy[i] += (pay[i] + newAy) * halfStep;
+		pvz[i] += (paz[i] + newAz) * halfStep;
+		pax[i] = newAx;
+		pay[i] = newAy;
+		paz[i] = newAz;
+	}
+}
+
+void populateBelt(TestParticles& particles, double centralMass, u32 count, double minRadius, double maxRadius, double inclinationSpread, u32 seed)
+{
+	std::mt19937 generator(seed);
+	for (u32 i = 0; i < count; i++)
+	{
+		vector3d<double> position;
+		vector3d<double> velocity;
+		randomCircularOrbit(generator, centralMass, minRadius, maxRadius, inclinationSpread, position, velocity);
+		particles.add(position, velocity);
+	}
+}
@@ -0,0 +1,38 @@
+#pragma once
+#include <vector>
+#include "CoreTypes.h"
+using namespace irr;
+using namespace core;
+
+//Massless particles orbiting a single central mass, stored as contiguous arrays so the
+//integrator and the renderer can stream through them. Positions are relative to the central mass.
+class TestParticles
+{
+public:
+	TestParticles();
+
+	void add(const vector3d<double>& position, const vector3d<double>& velocity);
+	void clear();
+	u32 size() const;
+
+	//Adds the J2 term of an oblate central mass spinning about pole, e.g. for ring particles. A j2 of 0 turns it off.
+	void setOblateness(double j2, double equatorialRadius, const vector3d<double>& pole);
+
+	//Leapfrog (velocity Verlet) step, matching integrate() with LEAPFROG.
+	void step(double centralMass, double timeStep);
+
+	std::vector<double> x, y, z;
+	std::vector<double> vx, vy, vz;
+
+private:
+	void computeAccelerations(double centralMass);
+	void stepOblate(double centralMass, double timeStep);
+
+	std::vector<double> ax, ay, az;
+	double accelerationMass; //Central mass the cached accelerations were computed for, 0 if none.
+	double j2;
+	double equatorialRadius;
+	vector3d<double> pole;
+};
+
+void populateBelt(TestParticles& particles, double centralMass, u32 count, double minRadius, double maxRadius, double inclinationSpread, u32 seed);
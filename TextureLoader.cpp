@@ -0,0 +1,346 @@
+#include "TextureLoader.h"
+#include <cstdio>
+#include <cstring>
+#include <sys/stat.h>
+
+static const c8 CACHE_MAGIC[4] = { 'S', 'S', 'M', 'C' };
+static const u32 CACHE_VERSION = 2;
+static const u32 PREVIEW_SIZE = 64;
+
+//Size and modification time of a file, both 0 if it does not exist.
+static void fileStamp(const io::path& filename, u32& size, u32& time)
+{
+	struct stat status;
+	if (stat(filename.c_str(), &status) != 0)
+	{
+		size = 0;
+		time = 0;
+		return;
+	}
+	size = (u32)status.st_size;
+	time = (u32)status.st_mtime;
+}
+
+//Number of pixels in all levels from size down to 1x1.
+static u32 mipmapChainSize(dimension2d<u32> size)
+{
+	u32 pixels = size.getArea();
+	while (size.Width > 1 || size.Height > 1)
+	{
+		size.Width = core::max_<u32>(size.Width / 2, 1);
+		size.Height = core::max_<u32>(size.Height / 2, 1);
+		pixels += size.getArea();
+	}
+	return pixels;
+}
+
+//Box filters each level from the one above, per channel.
+static void generateMipmaps(dimension2d<u32> size, std::vector<u32>& levels)
+{
+	levels.resize(mipmapChainSize(size));
+
+	u32* source = &levels[0];
+	while (size.Width > 1 || size.Height > 1)
+	{
+		dimension2d<u32> next(core::max_<u32>(size.Width / 2, 1), core::max_<u32>(size.Height / 2, 1));
+		u32* target = source + size.getArea();
+
+		for (u32 y = 0; y < next.Height; y++)
+		{
+			u32 y0 = core::min_<u32>(y * 2, size.Height - 1);
+			u32 y1 = core::min_<u32>(y * 2 + 1, size.Height - 1);
+			for (u32 x = 0; x < next.Width; x++)
+			{
+				u32 x0 = core::min_<u32>(x * 2, size.Width - 1);
+				u32 x1 = core::min_<u32>(x * 2 + 1, size.Width - 1);
+				u32 a = source[y0 * size.Width + x0];
+				u32 b = source[y0 * size.Width + x1];
+				u32 c = source[y1 * size.Width + x0];
+				u32 d = source[y1 * size.Width + x1];
+
+				u32 pixel = 0;
+				for (u32 shift = 0; shift < 32; shift += 8)
+				{
+					u32 sum = ((a >> shift) & 0xFF) + ((b >> shift) & 0xFF) + ((c >> shift) & 0xFF) + ((d >> shift) & 0xFF);
+					pixel |= ((sum + 2) / 4) << shift;
+				}
+				target[y * next.Width + x] = pixel;
+			}
+		}
+
+		source = target;
+		size = next;
+	}
+}
+
+TextureLoader::TextureLoader(IrrlichtDevice* device, const io::path& cacheDirectory, u32 threadCount)
+{
+	driver = device->getVideoDriver();
+	this->cacheDirectory = cacheDirectory;
+	pending = 0;
+	stopping = false;
+
+	if (threadCount == 0)
+	{
+		threadCount = std::thread::hardware_concurrency();
+	}
+	threadCount = core::max_<u32>(threadCount, 1);
+
+	for (u32 t = 0; t < threadCount; t++)
+	{
+		loaders.push_back(std::thread(&TextureLoader::load, this));
+	}
+}
+
+TextureLoader::~TextureLoader()
+{
+	{
+		std::lock_guard<std::mutex> lock(queueLock);
+		stopping = true;
+	}
+	queueChanged.notify_all();
+
+	for (u32 t = 0; t < loaders.size(); t++)
+	{
+		loaders[t].join();
+	}
+
+	for (u32 i = 0; i < requests.size(); i++)
+	{
+		delete requests[i];
+	}
+}
+
+video::ITexture* TextureLoader::request(const io::path& filename)
+{
+	if (filename.size() == 0)
+	{
+		return 0;
+	}
+
+	//Textures already uploaded, by this loader or elsewhere, are used as they are.
+	video::ITexture* texture = driver->findTexture(filename);
+	if (texture)
+	{
+		return texture;
+	}
+	for (u32 i = 0; i < requests.size(); i++)
+	{
+		if (requests[i]->filename == filename)
+		{
+			return requests[i]->placeholder;
+		}
+	}
+
+	Request* request = new Request();
+	request->filename = filename;
+	io::path name = filename;
+	core::deletePathFromFilename(name);
+	request->cacheFile = cacheDirectory + name + ".mip";
+	fileStamp(filename, request->sourceSize, request->sourceTime);
+
+	//Only the small end of the cached chain is read here, the full chain is left to the loader threads.
+	dimension2d<u32> previewSize;
+	std::vector<u32> preview;
+	video::IImage* image;
+	if (readCache(request, PREVIEW_SIZE, previewSize, preview))
+	{
+		image = driver->createImageFromData(video::ECF_A8R8G8B8, previewSize, &preview[0], true, false);
+	}
+	else
+	{
+		image = driver->createImage(video::ECF_A8R8G8B8, dimension2d<u32>(1, 1));
+		image->fill(video::SColor(255, 128, 128, 128));
+	}
+	request->placeholder = driver->addTexture(filename + "#preview", image);
+	image->drop();
+
+	requests.push_back(request);
+	pending++;
+	{
+		std::lock_guard<std::mutex> lock(queueLock);
+		queue.push_back(request);
+	}
+	queueChanged.notify_one();
+
+	return request->placeholder;
+}
+
+void TextureLoader::update(const array<Body*>& bodies, u32 maxUploads)
+{
+	//Uploads are spread over frames so no single frame stalls on several large textures.
+	for (u32 uploads = 0; uploads < maxUploads; uploads++)
+	{
+		Request* request;
+		{
+			std::lock_guard<std::mutex> lock(queueLock);
+			if (finished.empty())
+			{
+				return;
+			}
+			request = finished.front();
+			finished.pop_front();
+		}
+		pending--;
+
+		if (request->levels.empty())
+		{
+			continue;
+		}
+
+		//The image borrows the first level, the rest is passed on as the texture's mipmaps.
+		video::IImage* image = driver->createImageFromData(video::ECF_A8R8G8B8, request->size, &request->levels[0], true, false);
+		void* mipmaps = request->levels.size() > request->size.getArea() ? &request->levels[request->size.getArea()] : 0;
+		video::ITexture* texture = driver->addTexture(request->filename, image, mipmaps);
+		image->drop();
+		std::vector<u32>().swap(request->levels);
+
+		if (!texture)
+		{
+			continue;
+		}
+
+		for (u32 i = 0; i < bodies.size(); i++)
+		{
+			BodyVisual* visual = bodies[i]->visual;
+			for (u32 layer = 0; visual && layer < video::MATERIAL_MAX_TEXTURES; layer++)
+			{
+				if (visual->material.getTexture(layer) == request->placeholder)
+				{
+					visual->setTexture(layer, texture);
+				}
+			}
+		}
+		driver->removeTexture(request->placeholder);
+		request->placeholder = texture;
+	}
+}
+
+bool TextureLoader::isDone() const
+{
+	return pending == 0;
+}
+
+video::ITexture* TextureLoader::getTexture(const io::path& filename)
+{
+	std::lock_guard<std::mutex> lock(decodeLock);
+	return driver->getTexture(filename);
+}
+
+void TextureLoader::load()
+{
+	std::unique_lock<std::mutex> lock(queueLock);
+	while (true)
+	{
+		queueChanged.wait(lock, [this]() { return stopping || !queue.empty(); });
+
+		if (stopping)
+		{
+			return;
+		}
+
+		Request* request = queue.front();
+		queue.pop_front();
+
+		lock.unlock();
+		if (!readCache(request, 0, request->size, request->levels))
+		{
+			if (decode(request))
+			{
+				writeCache(request);
+			}
+			else
+			{
+				printf("Could not load texture %s\n", request->filename.c_str());
+			}
+		}
+		lock.lock();
+
+		finished.push_back(request);
+	}
+}
+
+//Reads the levels from the first one no larger than maxPreviewSize on, or all of them if it is 0.
+bool TextureLoader::readCache(const Request* request, u32 maxPreviewSize, dimension2d<u32>& size, std::vector<u32>& levels) const
+{
+	FILE* file = fopen(request->cacheFile.c_str(), "rb");
+	if (!file)
+	{
+		return false;
+	}
+
+	c8 magic[4];
+	u32 header[5];
+	bool valid = fread(magic, sizeof(magic), 1, file) == 1 && fread(header, sizeof(header), 1, file) == 1 &&
+		memcmp(magic, CACHE_MAGIC, sizeof(magic)) == 0 && header[0] == CACHE_VERSION && header[1] == request->sourceSize &&
+		header[2] == request->sourceTime && header[3] > 0 && header[4] > 0;
+
+	if (valid)
+	{
+		size = dimension2d<u32>(header[3], header[4]);
+		u32 skipped = 0;
+		if (maxPreviewSize > 0)
+		{
+			while (core::max_(size.Width, size.Height) > maxPreviewSize)
+			{
+				skipped += size.getArea();
+				size.Width = core::max_<u32>(size.Width / 2, 1);
+				size.Height = core::max_<u32>(size.Height / 2, 1);
+			}
+		}
+
+		levels.resize(mipmapChainSize(size));
+		valid = fseek(file, skipped * sizeof(u32), SEEK_CUR) == 0 && fread(&levels[0], sizeof(u32), levels.size(), file) == levels.size();
+	}
+
+	fclose(file);
+	if (!valid)
+	{
+		levels.clear();
+	}
+	return valid;
+}
+
+bool TextureLoader::decode(Request* request)
+{
+	video::IImage* image;
+	{
+		std::lock_guard<std::mutex> lock(decodeLock);
+		image = driver->createImageFromFile(request->filename);
+	}
+	if (!image)
+	{
+		return false;
+	}
+
+	//Scaled up to powers of two, so the mipmap chain matches what the driver expects.
+	request->size = image->getDimension().getOptimalSize(true, false);
+	request->levels.resize(request->size.getArea());
+	image->copyToScaling(&request->levels[0], request->size.Width, request->size.Height, video::ECF_A8R8G8B8);
+	image->drop();
+
+	generateMipmaps(request->size, request->levels);
+	return true;
+}
+
+void TextureLoader::writeCache(const Request* request) const
+{
+	//Loaders write to a temporary file first, so a cache file is either complete or absent.
+	io::path temporary = request->cacheFile + ".tmp";
+	FILE* file = fopen(temporary.c_str(), "wb");
+	if (!file)
+	{
+		return;
+	}
+
+	u32 header[5] = { CACHE_VERSION, request->sourceSize, request->sourceTime, request->size.Width, request->size.Height };
+	bool written = fwrite(CACHE_MAGIC, sizeof(CACHE_MAGIC), 1, file) == 1 && fwrite(header, sizeof(header), 1, file) == 1 &&
+		fwrite(&request->levels[0], sizeof(u32), request->levels.size(), file) == request->levels.size();
+	fclose(file);
+
+	remove(request->cacheFile.c_str());
+	if (!written || rename(temporary.c_str(), request->cacheFile.c_str()) != 0)
+	{
+		remove(temporary.c_str());
+	}
+}
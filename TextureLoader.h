@@ -0,0 +1,60 @@
+#pragma once
+#include <irrlicht.h>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "BodyVisual.h"
+using namespace irr;
+using namespace core;
+
+//Decodes textures on worker threads so startup does not wait for them. Until a texture is uploaded its bodies show a
+//small preview read from the mipmap cache, or a flat grey texture the first time a file is seen.
+//The cache holds every mipmap level as A8R8G8B8 and is rebuilt when the size or modification time of the source file changes.
+class TextureLoader
+{
+public:
+	TextureLoader(IrrlichtDevice* device, const io::path& cacheDirectory, u32 threadCount);
+	~TextureLoader();
+
+	video::ITexture* request(const io::path& filename);
+	void update(const array<Body*>& bodies, u32 maxUploads);
+	bool isDone() const;
+
+	//Loads a texture right away on the calling thread, for textures that are not worth a placeholder.
+	//Goes through the same lock as the loader threads, since the image loaders are not thread safe.
+	video::ITexture* getTexture(const io::path& filename);
+
+private:
+	struct Request
+	{
+		io::path filename;
+		io::path cacheFile;
+		u32 sourceSize;
+		u32 sourceTime; //Modification time, truncated to 32 bits since it is only compared.
+		video::ITexture* placeholder;
+		dimension2d<u32> size;
+		std::vector<u32> levels; //All mipmap levels one after another, largest first.
+	};
+
+	void load();
+	bool readCache(const Request* request, u32 maxPreviewSize, dimension2d<u32>& size, std::vector<u32>& levels) const;
+	bool decode(Request* request);
+	void writeCache(const Request* request) const;
+
+	video::IVideoDriver* driver;
+	io::path cacheDirectory;
+	array<Request*> requests;
+	u32 pending;
+
+	std::vector<std::thread> loaders;
+	std::mutex queueLock;
+	std::condition_variable queueChanged;
+	std::deque<Request*> queue;
+	std::deque<Request*> finished;
+	bool stopping;
+
+	//Irrlicht's image loaders share static state (the JPEG loader keeps the file name in a static), so only one decodes at a time.
+	std::mutex decodeLock;
+};
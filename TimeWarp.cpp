@@ -0,0 +1,56 @@
+#include "TimeWarp.h"
+#include <cmath>
+
+TimeWarp::TimeWarp(f64 warp, f64 minWarp, f64 maxWarp)
+{
+	this->minWarp = minWarp;
+	this->maxWarp = maxWarp;
+	this->warp = core::clamp(warp, minWarp, maxWarp);
+}
+
+static f64 nextStep(f64 value, bool up)
+{
+	//Walks the 1, 2, 5, 10, 20, ... ladder from the nearest rung in the requested direction.
+	f64 decade = pow(10.0, floor(log10(value)));
+	const f64 rungs[] = { 1, 2, 5, 10, 20 };
+	if (up)
+	{
+		for (u32 i = 0; i < 5; i++)
+		{
+			if (rungs[i] * decade > value * 1.0001)
+			{
+				return rungs[i] * decade;
+			}
+		}
+		return 20 * decade;
+	}
+
+	for (s32 i = 4; i >= 0; i--)
+	{
+		if (rungs[i] * decade < value * 0.9999)
+		{
+			return rungs[i] * decade;
+		}
+	}
+	return 0.5 * decade;
+}
+
+void TimeWarp::faster()
+{
+	warp = core::min_(nextStep(warp, true), maxWarp);
+}
+
+void TimeWarp::slower()
+{
+	warp = core::max_(nextStep(warp, false), minWarp);
+}
+
+f64 TimeWarp::simulatedTime(f64 realSeconds) const
+{
+	return warp * realSeconds;
+}
+
+u32 TimeWarp::substeps(f64 simulatedTime, f64 maxStep) const
+{
+	return core::max_<u32>((u32)ceil(simulatedTime / maxStep), 1);
+}
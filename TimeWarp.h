@@ -0,0 +1,22 @@
+#pragma once
+#include "CoreTypes.h"
+using namespace irr;
+using namespace core;
+
+//Simulated seconds per real second, stepped through 1-2-5 values between a lower and an upper limit.
+class TimeWarp
+{
+public:
+	TimeWarp(f64 warp, f64 minWarp, f64 maxWarp);
+
+	void faster();
+	void slower();
+
+	//Splits the simulated time covered by realSeconds into equal substeps no longer than maxStep.
+	f64 simulatedTime(f64 realSeconds) const;
+	u32 substeps(f64 simulatedTime, f64 maxStep) const;
+
+	f64 warp;
+	f64 minWarp;
+	f64 maxWarp;
+};
@@ -0,0 +1,346 @@
+#include "Trajectory.h"
+#include <cstring>
+#include <limits>
+#ifdef _IRR_WINDOWS_
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static const c8 TRAJECTORY_MAGIC[4] = { 'S', 'S', 'T', 'R' };
+static const u32 TRAJECTORY_VERSION = 2;
+static const u32 NAME_LENGTH = 32;
+static const u32 STATE_SIZE = 8; //Position, velocity, mass and radius.
+
+//Magic, version, body count and one unused word keep the records that follow 8 byte aligned.
+static size_t headerSize(u32 bodyCount)
+{
+	return sizeof(TRAJECTORY_MAGIC) + 3 * sizeof(u32) + bodyCount * NAME_LENGTH;
+}
+
+TrajectoryRecorder::TrajectoryRecorder(const io::path& fileName, const array<Body*>& bodies, double interval)
+{
+	this->interval = interval;
+	lastTime = 0;
+	recorded = false;
+
+	for (u32 i = 0; i < bodies.size(); i++)
+	{
+		slots.push_back(bodies[i]);
+	}
+	buffer.set_used(1 + STATE_SIZE * slots.size());
+
+	file = fopen(fileName.c_str(), "wb");
+	if (!file)
+	{
+		printf("Could not open trajectory file %s\n", fileName.c_str());
+		return;
+	}
+
+	u32 header[3] = { TRAJECTORY_VERSION, slots.size(), 0 };
+	fwrite(TRAJECTORY_MAGIC, sizeof(TRAJECTORY_MAGIC), 1, file);
+	fwrite(header, sizeof(header), 1, file);
+	for (u32 i = 0; i < slots.size(); i++)
+	{
+		c8 name[NAME_LENGTH] = {};
+		stringc narrow(slots[i]->name);
+		strncpy(name, narrow.c_str(), NAME_LENGTH - 1);
+		fwrite(name, NAME_LENGTH, 1, file);
+	}
+}
+
+TrajectoryRecorder::~TrajectoryRecorder()
+{
+	if (file)
+	{
+		fclose(file);
+	}
+}
+
+bool TrajectoryRecorder::isOpen() const
+{
+	return file != 0;
+}
+
+void TrajectoryRecorder::record(double time)
+{
+	if (!file || (recorded && time - lastTime < interval))
+	{
+		return;
+	}
+
+	//Removed slots are skipped, so the buffer still holds the sentinel written when they were removed.
+	buffer[0] = time;
+	for (u32 i = 0; i < slots.size(); i++)
+	{
+		if (slots[i])
+		{
+			double* state = &buffer[1 + STATE_SIZE * i];
+			state[0] = slots[i]->position.X;
+			state[1] = slots[i]->position.Y;
+			state[2] = slots[i]->position.Z;
+			state[3] = slots[i]->velocity.X;
+			state[4] = slots[i]->velocity.Y;
+			state[5] = slots[i]->velocity.Z;
+			state[6] = slots[i]->mass;
+			state[7] = slots[i]->radius;
+		}
+	}
+
+	if (fwrite(buffer.const_pointer(), sizeof(double), buffer.size(), file) != buffer.size())
+	{
+		printf("Could not write trajectory record, recording stopped\n");
+		fclose(file);
+		file = 0;
+		return;
+	}
+	lastTime = time;
+	recorded = true;
+}
+
+void TrajectoryRecorder::bodyRemoved(const Body* body)
+{
+	for (u32 i = 0; i < slots.size(); i++)
+	{
+		if (slots[i] == body)
+		{
+			slots[i] = 0;
+			double* state = &buffer[1 + STATE_SIZE * i];
+			for (u32 j = 0; j < STATE_SIZE; j++)
+			{
+				state[j] = std::numeric_limits<double>::quiet_NaN();
+			}
+		}
+	}
+}
+
+TrajectoryReplay::TrajectoryReplay(const io::path& fileName)
+{
+	data = 0;
+	size = 0;
+	bodyCount = 0;
+	recordCount = 0;
+	recordStride = 1;
+	lastRecord = 0;
+
+#ifdef _IRR_WINDOWS_
+	HANDLE file = CreateFileA(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, 0, OPEN_EXISTING, FILE_FLAG_RANDOM_ACCESS, 0);
+	if (file != INVALID_HANDLE_VALUE)
+	{
+		LARGE_INTEGER fileSize;
+		HANDLE mapping = GetFileSizeEx(file, &fileSize) && fileSize.QuadPart > 0 ? CreateFileMappingA(file, 0, PAGE_READONLY, 0, 0, 0) : 0;
+		if (mapping)
+		{
+			//The view keeps the mapping alive after both handles are closed.
+			data = (const u8*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+			size = data ? (size_t)fileSize.QuadPart : 0;
+			CloseHandle(mapping);
+		}
+		CloseHandle(file);
+	}
+#else
+	int file = open(fileName.c_str(), O_RDONLY);
+	if (file >= 0)
+	{
+		struct stat status;
+		if (fstat(file, &status) == 0 && status.st_size > 0)
+		{
+			void* mapped = mmap(0, status.st_size, PROT_READ, MAP_SHARED, file, 0);
+			if (mapped != MAP_FAILED)
+			{
+				data = (const u8*)mapped;
+				size = status.st_size;
+			}
+		}
+		close(file);
+	}
+#endif
+
+	if (!data)
+	{
+		printf("Could not map trajectory file %s\n", fileName.c_str());
+		return;
+	}
+
+	u32 header[3];
+	if (size < headerSize(0) || memcmp(data, TRAJECTORY_MAGIC, sizeof(TRAJECTORY_MAGIC)) != 0)
+	{
+		printf("%s is not a trajectory file\n", fileName.c_str());
+		return;
+	}
+	memcpy(header, data + sizeof(TRAJECTORY_MAGIC), sizeof(header));
+	if (header[0] != TRAJECTORY_VERSION || size < headerSize(header[1]))
+	{
+		printf("%s has an unsupported version or is truncated\n", fileName.c_str());
+		return;
+	}
+
+	//A record cut short by a crash while recording is ignored.
+	bodyCount = header[1];
+	recordStride = 1 + STATE_SIZE * bodyCount;
+	recordCount = (u32)((size - headerSize(bodyCount)) / (recordStride * sizeof(double)));
+}
+
+TrajectoryReplay::~TrajectoryReplay()
+{
+	if (data)
+	{
+#ifdef _IRR_WINDOWS_
+		UnmapViewOfFile(data);
+#else
+		munmap((void*)data, size);
+#endif
+	}
+}
+
+bool TrajectoryReplay::matches(const array<Body*>& bodies) const
+{
+	if (recordCount == 0 || bodies.size() != bodyCount)
+	{
+		return false;
+	}
+
+	const c8* names = (const c8*)data + headerSize(0);
+	for (u32 i = 0; i < bodyCount; i++)
+	{
+		stringc narrow(bodies[i]->name);
+		if (strncmp(names + i * NAME_LENGTH, narrow.c_str(), NAME_LENGTH - 1) != 0)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+double TrajectoryReplay::getStartTime() const
+{
+	return recordCount > 0 ? getRecord(0)[0] : 0;
+}
+
+double TrajectoryReplay::getEndTime() const
+{
+	return recordCount > 0 ? getRecord(recordCount - 1)[0] : 0;
+}
+
+const double* TrajectoryReplay::getRecord(u32 index) const
+{
+	return (const double*)(data + headerSize(bodyCount)) + (size_t)index * recordStride;
+}
+
+//Index of the last record at or before time. Playback mostly moves by less than a record per frame,
+//so the last record used and its neighbours are tried before searching.
+u32 TrajectoryReplay::findRecord(double time)
+{
+	if (time <= getRecord(0)[0])
+	{
+		return 0;
+	}
+	if (time >= getRecord(recordCount - 1)[0])
+	{
+		return recordCount - 1;
+	}
+
+	u32 low = 0;
+	u32 high = recordCount - 1;
+	if (getRecord(lastRecord)[0] <= time)
+	{
+		low = lastRecord;
+		if (lastRecord + 1 < recordCount && time < getRecord(lastRecord + 1)[0])
+		{
+			return lastRecord;
+		}
+	}
+	else
+	{
+		high = lastRecord;
+		if (lastRecord > 0 && getRecord(lastRecord - 1)[0] <= time)
+		{
+			return lastRecord - 1;
+		}
+	}
+
+	//Invariant: record low is at or before time, record high is after it.
+	while (high - low > 1)
+	{
+		u32 middle = low + (high - low) / 2;
+		if (getRecord(middle)[0] <= time)
+		{
+			low = middle;
+		}
+		else
+		{
+			high = middle;
+		}
+	}
+	return low;
+}
+
+void TrajectoryReplay::seek(double time, const array<Body*>& bodies)
+{
+	if (recordCount == 0)
+	{
+		return;
+	}
+
+	lastRecord = findRecord(time);
+	const double* first = getRecord(lastRecord);
+	const double* second = getRecord(core::min_(lastRecord + 1, recordCount - 1));
+
+	double duration = second[0] - first[0];
+	double t = duration > 0 ? core::clamp((time - first[0]) / duration, 0.0, 1.0) : 0;
+	double t2 = t * t;
+	double t3 = t2 * t;
+	double h00 = 2 * t3 - 3 * t2 + 1;
+	double h10 = t3 - 2 * t2 + t;
+	double h01 = -2 * t3 + 3 * t2;
+	double h11 = t3 - t2;
+
+	//Derivatives of the basis functions give the velocity along the same spline.
+	double d00 = 6 * t2 - 6 * t;
+	double d10 = 3 * t2 - 4 * t + 1;
+	double d01 = -6 * t2 + 6 * t;
+	double d11 = 3 * t2 - 2 * t;
+
+	u32 count = core::min_(bodies.size(), bodyCount);
+	for (u32 i = 0; i < count; i++)
+	{
+		const double* a = first + 1 + STATE_SIZE * i;
+		const double* b = second + 1 + STATE_SIZE * i;
+
+		//NaN never equals itself, which marks a removed slot.
+		bodies[i]->removed = a[0] != a[0];
+		if (bodies[i]->removed)
+		{
+			continue;
+		}
+		bodies[i]->mass = a[6];
+		bodies[i]->radius = a[7];
+
+		vector3d<double> p0(a[0], a[1], a[2]);
+		vector3d<double> v0(a[3], a[4], a[5]);
+		vector3d<double> p1(b[0], b[1], b[2]);
+		vector3d<double> v1(b[3], b[4], b[5]);
+
+		//Removed before the next record, so there is nothing to spline towards. The body coasts until the next record hides it.
+		if (b[0] != b[0])
+		{
+			bodies[i]->position = p0 + v0 * (t * duration);
+			bodies[i]->velocity = v0;
+		}
+		else if (duration > 0)
+		{
+			bodies[i]->position = p0 * h00 + v0 * (h10 * duration) + p1 * h01 + v1 * (h11 * duration);
+			bodies[i]->velocity = (p0 * d00 + p1 * d01) / duration + v0 * d10 + v1 * d11;
+		}
+		else
+		{
+			bodies[i]->position = p0;
+			bodies[i]->velocity = v0;
+		}
+	}
+}
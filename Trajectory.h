@@ -0,0 +1,59 @@
+#pragma once
+#include <cstdio>
+#include "Body.h"
+using namespace irr;
+using namespace core;
+
+//Trajectory files hold a header with the body names followed by fixed size records of the time and every
+//body's position, velocity, mass and radius, in the order the bodies were created.
+
+//Appends a record of all bodies whenever at least interval simulated seconds have passed since the last one.
+//Bodies removed by collisions keep their slot with a NaN position from then on, so the record size never changes.
+class TrajectoryRecorder
+{
+public:
+	TrajectoryRecorder(const io::path& fileName, const array<Body*>& bodies, double interval);
+	~TrajectoryRecorder();
+
+	bool isOpen() const;
+	void record(double time);
+	void bodyRemoved(const Body* body);
+
+private:
+	FILE* file;
+	array<const Body*> slots;
+	array<double> buffer;
+	double interval;
+	double lastTime;
+	bool recorded;
+};
+
+//Plays a trajectory file back without integrating. The file is memory mapped, so only the records that are
+//looked at are read from disk, and seeking is a binary search over the record times that starts from the last record used.
+class TrajectoryReplay
+{
+public:
+	TrajectoryReplay(const io::path& fileName);
+	~TrajectoryReplay();
+
+	//True if the file was recorded from bodies with the same names in the same order.
+	bool matches(const array<Body*>& bodies) const;
+	double getStartTime() const;
+	double getEndTime() const;
+
+	//Sets the position and velocity of every body from a cubic Hermite spline between the records around time,
+	//and the mass and radius from the record before it. Bodies already removed at time are marked as removed and
+	//otherwise left as they are, a body removed before the next record coasts on from its last recorded state.
+	void seek(double time, const array<Body*>& bodies);
+
+private:
+	const double* getRecord(u32 index) const;
+	u32 findRecord(double time);
+
+	const u8* data;
+	size_t size;
+	u32 bodyCount;
+	u32 recordCount;
+	u32 recordStride; //Doubles per record.
+	u32 lastRecord;
+};
@@ -0,0 +1,155 @@
+#include <cstdio>
+#include "Body.h"
+#include "Collisions.h"
+#include "EncounterMonitor.h"
+#include "Ensemble.h"
+#include "Ephemeris.h"
+#include "Simulation.h"
+#include "Trajectory.h"
+using namespace irr;
+using namespace core;
+
+//Runs the simulation without a window, built only from the core library so it needs neither Irrlicht nor OpenGL.
+//Meant for long runs on machines without graphics; the recorded trajectory can be watched later in the replay mode.
+int main()
+{
+	//SETTINGS/////////////////////////
+	int integrationMethod = LEAPFROG;
+	int timeStep = 86400; // 1 day
+	double years = 1000;
+
+	u32 nrOfAsteroids = 0;
+
+	bool collisionsEnabled = true;
+	int collisionResponse = COLLISION_MERGE;
+
+	bool monitorEncounters = true;
+	double encounterHillRadii = 3; //Pairs closer than this many Hill radii of the larger one are logged.
+	io::path encounterLog = "encounters.csv";
+
+	io::path recordTrajectory = "trajectory.bin"; //Nothing is recorded if empty.
+	double recordInterval = 86400; //Simulated seconds between records.
+
+	bool runEphemerisValidation = false; //Compares against reference files instead of simulating.
+	io::path ephemerisDirectory = "resources/ephemeris/";
+	io::path ephemerisReport = "ephemeris_errors.csv";
+	u32 validationThreads = 0; //Uses all hardware threads if set to 0.
+
+	bool runEnsembleMode = false; //Runs many perturbed simulations instead of a single one.
+	u32 ensembleRuns = 300;
+	double ensembleYears = 100;
+	double ensemblePerturbation = 1e-6;
+	io::path ensembleOutput = "ensemble_results.csv";
+	u32 ensembleThreads = 0; //Uses all hardware threads if set to 0.
+	bool batchedEnsembleKernel = true; //Advances leapfrog runs with equal time steps side by side in vector lanes.
+	///////////////////////////////////
+
+	if (runEphemerisValidation)
+	{
+		return validateEphemeris(ephemerisDirectory, ephemerisReport, timeStep, integrationMethod, validationThreads);
+	}
+
+	if (runEnsembleMode)
+	{
+		array<double> timeSteps;
+		timeSteps.push_back(timeStep * 0.5);
+		timeSteps.push_back(timeStep);
+		timeSteps.push_back(timeStep * 2.0);
+
+		array<int> integrationMethods;
+		integrationMethods.push_back(EULER);
+		integrationMethods.push_back(LEAPFROG);
+		integrationMethods.push_back(RK4);
+
+		array<EnsembleRun> runs = createParameterSweep(ensembleRuns, timeSteps, integrationMethods, ensemblePerturbation, ensemblePerturbation, 1);
+		return runEnsemble(runs, ensembleYears * 365.25 * 86400, ensembleOutput, ensembleThreads, batchedEnsembleKernel);
+	}
+
+	array<Body*> bodies = createBodies();
+	array<Body*> asteroids = createAsteroidBelt(bodies[0], nrOfAsteroids, 1);
+	for (u32 i = 0; i < asteroids.size(); i++)
+	{
+		bodies.push_back(asteroids[i]);
+	}
+
+	EncounterMonitor* encounterMonitor = 0;
+	if (monitorEncounters)
+	{
+		encounterMonitor = new EncounterMonitor(encounterLog, encounterHillRadii);
+	}
+
+	double simulationTime = 0;
+	TrajectoryRecorder* recorder = 0;
+	if (recordTrajectory.size() > 0)
+	{
+		recorder = new TrajectoryRecorder(recordTrajectory, bodies, recordInterval);
+		recorder->record(simulationTime);
+	}
+
+	array<vector3d<double> > previousPositions;
+	array<Collision> collisions;
+	double endTime = years * 365.25 * 86400;
+	u32 reportedPercent = 0;
+
+	while (simulationTime < endTime)
+	{
+		previousPositions.set_used(0);
+		for (u32 i = 0; i < bodies.size(); i++)
+		{
+			previousPositions.push_back(bodies[i]->position);
+		}
+
+		for (u32 i = 1; i < bodies.size(); i++)
+		{
+			integrate(bodies[0], bodies[i], timeStep, integrationMethod);
+		}
+
+		if (collisionsEnabled)
+		{
+			detectCollisions(bodies, previousPositions, collisions);
+			if (!collisions.empty())
+			{
+				array<Body*> removed;
+				resolveCollisions(bodies, collisions, collisionResponse, removed);
+				for (u32 i = 0; i < removed.size(); i++)
+				{
+					if (recorder)
+					{
+						recorder->bodyRemoved(removed[i]);
+					}
+					if (encounterMonitor)
+					{
+						encounterMonitor->bodyRemoved(removed[i]);
+					}
+					delete removed[i];
+				}
+			}
+		}
+
+		simulationTime += timeStep;
+		if (encounterMonitor)
+		{
+			encounterMonitor->update(bodies, simulationTime, timeStep);
+		}
+		if (recorder)
+		{
+			recorder->record(simulationTime);
+		}
+
+		u32 percent = (u32)(simulationTime / endTime * 100);
+		if (percent >= reportedPercent + 10)
+		{
+			reportedPercent = percent - percent % 10;
+			printf("%u%% (%.0f years)\n", reportedPercent, simulationTime / (365.25 * 86400));
+		}
+	}
+
+	delete encounterMonitor;
+	delete recorder;
+	for (u32 i = 0; i < bodies.size(); i++)
+	{
+		delete bodies[i];
+	}
+
+	return 0;
+}
@@ -1,5 +1,32 @@
 ﻿#include <irrlicht.h>
+#include <cmath>
+#include <cstdio>
+#include <cwchar>
 #include "Body.h"
+#include "BodyBatchSceneNode.h"
+#include "BodyPicker.h"
+#include "BodyVisual.h"
+#include "CameraPath.h"
+#include "Collisions.h"
+#include "Culling.h"
+#include "EncounterMonitor.h"
+#include "Ensemble.h"
+#include "Ephemeris.h"
+#include "FollowCamera.h"
+#include "FrameWriter.h"
+#include "InputReceiver.h"
+#include "LabelRenderer.h"
+#include "Orbit.h"
+#include "ParticleSceneNode.h"
+#include "PlanetShader.h"
+#include "Profiler.h"
+#include "RenderFrame.h"
+#include "Rings.h"
+#include "Simulation.h"
+#include "SphereLod.h"
+#include "TextureLoader.h"
+#include "TimeWarp.h"
+#include "Trajectory.h"
 using namespace irr;
 using namespace core;
 using namespace scene;
@@ -12,33 +39,132 @@ using namespace gui;
 #pragma comment(linker, "/subsystem:windows /ENTRY:mainCRTStartup")
 #endif
 
-#define G 6.6743e-11
-
-enum IntegrationMethod { EULER, LEAPFROG, RK4 };
-
-void plotOrbit(Body*, u32, u32, u32, double, IrrlichtDevice*);
-void integrate(Body*, Body*, u32);
-array<Body*> createBodies(IrrlichtDevice*, u32, double);
+void plotOrbit(Body*, double, u32, const RenderFrame&, IrrlichtDevice*);
+void plotOsculatingOrbit(Body*, const Body*, u32, double, const RenderFrame&, IrrlichtDevice*);
+void updateReadouts(LabelRenderer&, const Body*, const Body*);
 
 int main()
 {
 	//SETTINGS/////////////////////////
 	int integrationMethod = LEAPFROG;
-	int timeStep = 86400; // 1 day
+	int timeStep = 86400; // 1 day, the longest substep taken
 
 	bool plotOrbits = true;
-	u32 plotRadius = 100;
-	u32 plotInterval = 10;
-	u32 nrOfPlotPoints = 1000;
+	double plotTolerance = 10; //Draw units a trail may stray from the path it follows; straight stretches get fewer points.
+	u32 nrOfPlotPoints = 1000; //Vertex budget of each trail.
+	bool plotOsculatingOrbits = false; //Draws each body's current Kepler ellipse around the Sun instead of its trail.
+	u32 osculatingSegments = 256;
+	double osculatingTolerance = 1e-4; //Change in elements before an ellipse is rebuilt.
+
+	bool collisionsEnabled = true;
+	int collisionResponse = COLLISION_MERGE;
+
+	bool monitorEncounters = true;
+	double encounterHillRadii = 3; //Pairs closer than this many Hill radii of the larger one are logged.
+	io::path encounterLog = "encounters.csv";
 
 	double distanceScale = 1e-7;
+	int distanceScaling = SCALE_LINEAR; //SCALE_LOG or SCALE_ASINH compress distances from the Sun, so the outer planets fit on screen with the inner ones.
+	double scalingRadius = 1.495978707e11; //Distances well below this stay close to linear.
 	u32 fixedPlanetDrawSize = 1e3; //Uses true planet radius if set to 0.
 
+	u32 nrOfAsteroids = 0;
+	f32 asteroidDrawSize = 200;
+
+	u32 nrOfBeltParticles = 0; //Massless particles, far cheaper than asteroids but invisible to the other bodies.
+	f32 beltParticleSize = 1;
+
+	int ringMode = RINGS_TEXTURED; //RINGS_PARTICLES simulates the rings of Saturn and Uranus in the planet's frame instead.
+	u32 nrOfRingParticles = 20000; //Per planet.
+	f32 ringParticleSize = 1;
+	double ringTimeStep = 300; //Ring orbits take hours, so they need far shorter steps than the planets.
+	u32 maxRingStepsPerUpdate = 32; //Per substep. Time beyond it is dropped, so at the default warp the rings turn slower than the planets.
+
 	u32 msBetweenUpdate = 16;
 	u32 msBetweenDraw = 16;
+	u32 msBetweenOverlay = 250;
+	u32 msPhysicsBudget = 12; //Real time per update that substeps may use at high warp.
+	u32 msMaxUpdateGap = 250;
+	double minWarp = 1; //Simulated seconds per second, changed with +/-.
+	double maxWarp = 1e5 * 86400;
+	bool cullingEnabled = true; //Hides spheres and trails outside the view or smaller than minPixelSize before drawing.
+	f32 minPixelSize = 1;
+	u32 pickCellSize = 32; //Pixels per side of the screen grid bodies are binned into for picking.
+	f32 pickRadius = 6; //Pixels around a body or trail that still pick it. Clicking elsewhere stops following.
+	bool showLabels = true; //Body names next to planets and moons, overlapping names are left out.
+	bool showHud = true; //Distance, speed and orbital period of the followed body.
+	bool interpolateDraw = true; //Draws between the last two physics states, one update behind, so uneven update and draw rates stay smooth. Belt and ring particles are not interpolated and show the latest state.
+	double maxInterpolatedSpan = 4 * 86400; //Updates covering more simulated time are not interpolated; a twentieth of Mercury's orbit.
+
+	bool asyncTextures = true; //Shows previews while planet textures decode in the background.
+	io::path textureCache = "resources/texture_cache/"; //Mipmapped copies that make later startups fast.
+	u32 textureThreads = 0; //Uses all hardware threads if set to 0.
+	u32 textureUploadsPerFrame = 1;
+	bool planetShading = true; //Day/night/cloud layers for the Earth, lit by the Sun. Needs GLSL.
+	io::path shaderDirectory = "resources/shaders/";
+
+	io::path recordTrajectory = ""; //Records every body's state to this file if set, for later replay.
+	double recordInterval = 86400; //Simulated seconds between records.
+	io::path replayTrajectory = ""; //Plays a recording back instead of simulating. R reverses, space pauses, Home/End jump to the ends.
+	double replayMaxWarp = 1e4 * 365.25 * 86400;
+
+	bool showProfiler = true;
+	io::path profileCsv = ""; //Writes per frame phase timings if set.
+
+	bool renderOffline = false; //Renders a fixed number of frames with the software renderer and saves them as images.
+	u32 offlineFrames = 1800;
+	double offlineTimePerFrame = 86400; //Simulated seconds between saved frames.
+	dimension2d<u32> offlineResolution(1280, 720);
+	io::path offlineFramePrefix = "frames/frame_"; //The directory has to exist.
+	io::path offlineFrameExtension = ".png";
+	u32 offlineWriterThreads = 0; //Uses all hardware threads if set to 0.
+	u32 offlineMaxQueuedFrames = 16;
+	bool offlineCameraPath = true; //Flies the camera along createCameraPath() instead of holding the starting view.
+
+	bool runEphemerisValidation = false; //Compares against reference files instead of opening a window.
+	io::path ephemerisDirectory = "resources/ephemeris/";
+	io::path ephemerisReport = "ephemeris_errors.csv";
+	u32 validationThreads = 0; //Uses all hardware threads if set to 0.
+
+	bool runEnsembleMode = false; //Runs many perturbed headless simulations instead of opening a window.
+	u32 ensembleRuns = 300;
+	double ensembleYears = 100;
+	double ensemblePerturbation = 1e-6;
+	io::path ensembleOutput = "ensemble_results.csv";
+	u32 ensembleThreads = 0; //Uses all hardware threads if set to 0.
+	bool batchedEnsembleKernel = true; //Advances leapfrog runs with equal time steps side by side in vector lanes.
 	///////////////////////////////////
 
-	IrrlichtDevice *device = createDevice(video::EDT_OPENGL, dimension2d<u32>(1600, 900), 16, false, false, false, 0);
+	if (runEphemerisValidation)
+	{
+		return validateEphemeris(ephemerisDirectory, ephemerisReport, timeStep, integrationMethod, validationThreads);
+	}
+
+	if (runEnsembleMode)
+	{
+		array<double> timeSteps;
+		timeSteps.push_back(timeStep * 0.5);
+		timeSteps.push_back(timeStep);
+		timeSteps.push_back(timeStep * 2.0);
+
+		array<int> integrationMethods;
+		integrationMethods.push_back(EULER);
+		integrationMethods.push_back(LEAPFROG);
+		integrationMethods.push_back(RK4);
+
+		array<EnsembleRun> runs = createParameterSweep(ensembleRuns, timeSteps, integrationMethods, ensemblePerturbation, ensemblePerturbation, 1);
+		return runEnsemble(runs, ensembleYears * 365.25 * 86400, ensembleOutput, ensembleThreads, batchedEnsembleKernel);
+	}
+
+	IrrlichtDevice *device;
+	if (renderOffline)
+	{
+		device = createDevice(video::EDT_BURNINGSVIDEO, offlineResolution, 32, false, false, false, 0);
+	}
+	else
+	{
+		device = createDevice(video::EDT_OPENGL, dimension2d<u32>(1600, 900), 16, false, false, false, 0);
+	}
 
 	if (!device)
 		return 1;
@@ -52,263 +178,501 @@ int main()
 	ISceneManager* smgr = device->getSceneManager();
 	IGUIEnvironment* guienv = device->getGUIEnvironment();
 
-	array<Body*> bodies = createBodies(device, fixedPlanetDrawSize, distanceScale);
+	//Offline frames must not show placeholders, so textures are loaded up front there.
+	TextureLoader* textureLoader = 0;
+	if (asyncTextures && !renderOffline)
+	{
+		textureLoader = new TextureLoader(device, textureCache, textureThreads);
+	}
 
-	ICameraSceneNode* camera = smgr->addCameraSceneNodeFPS(0, 100, 200, -1, 0, 0, false, 0, false, true);
+	array<Body*> bodies = createBodies();
+	SphereLod sphereLod(smgr);
+	createBodyVisuals(bodies, fixedPlanetDrawSize, distanceScale, device, textureLoader, sphereLod);
+
+	PlanetShader* planetShader = 0;
+	if (planetShading)
+	{
+		planetShader = new PlanetShader(device, shaderDirectory + "planet.vert", shaderDirectory + "planet.frag");
+		planetShader->apply(bodies, createPlanetLayers(), textureLoader);
+	}
+
+	RenderFrame renderFrame(distanceScale);
+	renderFrame.setScaling(distanceScaling, scalingRadius);
+
+	array<Body*> asteroids = createAsteroidBelt(bodies[0], nrOfAsteroids, 1);
+	for (u32 i = 0; i < asteroids.size(); i++)
+	{
+		bodies.push_back(asteroids[i]);
+	}
+
+	BodyBatchSceneNode* bodyBatch = new BodyBatchSceneNode(smgr->getRootSceneNode(), smgr, &bodies, &renderFrame, asteroidDrawSize, SColor(255, 170, 160, 150));
+	bodyBatch->drop();
+
+	TestParticles beltParticles;
+	populateBelt(beltParticles, bodies[0]->mass, nrOfBeltParticles, 3.1e11, 4.9e11, 8 * DEGTORAD64, 2); //2.1 - 3.3 AU
+	ParticleSceneNode* beltNode = new ParticleSceneNode(smgr->getRootSceneNode(), smgr, &beltParticles, &renderFrame, beltParticleSize, SColor(255, 150, 140, 130));
+	beltNode->drop();
+
+	array<PlanetRings*> rings = createRings(bodies, ringMode, nrOfRingParticles, ringParticleSize, &renderFrame, device, textureLoader);
+
+	//Offline frames have no input, and the FPS controls would fight a scripted camera, so a plain camera is used there.
+	ICameraSceneNode* camera = renderOffline ? smgr->addCameraSceneNode() : smgr->addCameraSceneNodeFPS(0, 100, 200, -1, 0, 0, false, 0, false, true);
 	camera->setFOV(1);
 	camera->setPosition(vector3df(0, 0, 5e5));
 	camera->setTarget(vector3df(0));
 	camera->setFarValue(1e7);
 
+	BodyPicker picker(pickCellSize, pickRadius);
+	FollowCamera followCamera;
+	CameraPath* cameraPath = 0;
+	if (renderOffline && offlineCameraPath)
+	{
+		cameraPath = new CameraPath(createCameraPath());
+	}
+	LabelRenderer labels(device, 8, 8, 4);
+
+	array<vector3d<double> > previousPositions;
+	array<Collision> collisions;
+
+	EncounterMonitor* encounterMonitor = 0;
+	if (monitorEncounters)
+	{
+		encounterMonitor = new EncounterMonitor(encounterLog, encounterHillRadii);
+	}
+	double simulationTime = 0;
+
+	//Replays need the same bodies as the recording, so they are created as usual and only moved by the replay.
+	TrajectoryReplay* replay = 0;
+	double replayDirection = 1;
+	bool replayPaused = false;
+	if (replayTrajectory.size() > 0)
+	{
+		replay = new TrajectoryReplay(replayTrajectory);
+		if (replay->matches(bodies))
+		{
+			simulationTime = replay->getStartTime();
+			replay->seek(simulationTime, bodies);
+		}
+		else
+		{
+			printf("%s does not match the current bodies, simulating instead\n", replayTrajectory.c_str());
+			delete replay;
+			replay = 0;
+		}
+	}
+
+	TrajectoryRecorder* recorder = 0;
+	if (recordTrajectory.size() > 0 && !replay)
+	{
+		recorder = new TrajectoryRecorder(recordTrajectory, bodies, recordInterval);
+		recorder->record(simulationTime);
+	}
+
+	Profiler profiler;
+	if (showProfiler && !renderOffline)
+	{
+		profiler.createOverlay(guienv, rect<s32>(10, 10, 330, 160));
+	}
+	if (profileCsv.size() > 0)
+	{
+		profiler.openCsv(profileCsv);
+	}
+	wchar_t caption[128];
+
+	InputReceiver input;
+	device->setEventReceiver(&input);
+
+	//Starts at the old fixed rate of one time step per update.
+	TimeWarp timeWarp(timeStep * 1000.0 / msBetweenUpdate, minWarp, replay ? replayMaxWarp : maxWarp);
+	double achievedWarp = timeWarp.warp;
+	double lastUpdateDuration = 0;
+
+	FrameWriter* frameWriter = 0;
+	u32 framesRendered = 0;
+	if (renderOffline)
+	{
+		frameWriter = new FrameWriter(device, offlineFramePrefix, offlineFrameExtension, offlineWriterThreads, offlineMaxQueuedFrames);
+		//Nothing could be saved, so no frame is rendered at all.
+		if (!frameWriter->isOpen())
+		{
+			device->closeDevice();
+		}
+	}
+
 	u32 lastDrawTime = timer->getTime();
 	u32 lastUpdateTime = lastDrawTime;
+	u32 lastOverlayTime = lastDrawTime;
 
 	while (device->run())
 	{
 		u32 currentTime = timer->getTime();
 
-		if (currentTime - lastUpdateTime >= msBetweenUpdate)
+		//Offline frames advance by a fixed simulated time each, however long they take to render.
+		if (renderOffline || currentTime - lastUpdateTime >= msBetweenUpdate)
 		{
-			for (u32 i = 1; i < bodies.size(); i++)
+			if (input.wasKeyPressed(KEY_PLUS) || input.wasKeyPressed(KEY_ADD))
+			{
+				timeWarp.faster();
+			}
+			if (input.wasKeyPressed(KEY_MINUS) || input.wasKeyPressed(KEY_SUBTRACT))
+			{
+				timeWarp.slower();
+			}
+			if (replay)
+			{
+				if (input.wasKeyPressed(KEY_KEY_R))
+				{
+					replayDirection = -replayDirection;
+				}
+				if (input.wasKeyPressed(KEY_SPACE))
+				{
+					replayPaused = !replayPaused;
+				}
+				if (input.wasKeyPressed(KEY_HOME))
+				{
+					simulationTime = replay->getStartTime();
+					replay->seek(simulationTime, bodies);
+				}
+				if (input.wasKeyPressed(KEY_END))
+				{
+					simulationTime = replay->getEndTime();
+					replay->seek(simulationTime, bodies);
+				}
+			}
+
+			//Long stalls (window dragged, breakpoints) are not caught up on.
+			u32 elapsed = core::min_<u32>(currentTime - lastUpdateTime, msMaxUpdateGap);
+			double simulatedTime = renderOffline ? offlineTimePerFrame : timeWarp.simulatedTime(elapsed / 1000.0);
+			u32 substeps = timeWarp.substeps(simulatedTime, timeStep);
+			double substep = simulatedTime / substeps;
+
+			for (u32 i = 0; i < bodies.size(); i++)
 			{
-				if (plotOrbits)
+				bodies[i]->saveState();
+			}
+
+			//Trails get one point per update however many substeps are taken, so high warp costs no extra trail work.
+			profiler.begin(PROFILE_TRAILS);
+			if (plotOrbits)
+			{
+				for (u32 i = 1; i < bodies.size(); i++)
+				{
+					if (!bodies[i]->visual || bodies[i]->removed)
+					{
+						continue;
+					}
+					if (plotOsculatingOrbits)
+					{
+						plotOsculatingOrbit(bodies[i], bodies[0], osculatingSegments, osculatingTolerance, renderFrame, device);
+					}
+					else
+					{
+						plotOrbit(bodies[i], plotTolerance, nrOfPlotPoints, renderFrame, device);
+					}
+				}
+			}
+			profiler.end(PROFILE_TRAILS);
+
+			//Replays only look up the recorded states, so any warp costs the same.
+			if (replay)
+			{
+				double replayTime = core::clamp(simulationTime + (replayPaused ? 0 : replayDirection * simulatedTime), replay->getStartTime(), replay->getEndTime());
+				replay->seek(replayTime, bodies);
+				if (followCamera.getBody() && followCamera.getBody()->removed)
+				{
+					followCamera.stop();
+				}
+				lastUpdateDuration = replayTime - simulationTime;
+				achievedWarp = elapsed > 0 ? fabs(lastUpdateDuration) / (elapsed / 1000.0) : 0;
+				simulationTime = replayTime;
+			}
+			else
+			{
+				u32 budgetStart = timer->getRealTime();
+				u32 substepsTaken = 0;
+				while (substepsTaken < substeps)
 				{
-					plotOrbit(bodies[i], plotInterval, plotRadius, nrOfPlotPoints, distanceScale, device);
+					previousPositions.set_used(0);
+					for (u32 i = 0; i < bodies.size(); i++)
+					{
+						previousPositions.push_back(bodies[i]->position);
+					}
+
+					//Force evaluation happens inside integrate(), so it is timed together with the integration.
+					profiler.begin(PROFILE_PHYSICS);
+					for (u32 i = 1; i < bodies.size(); i++)
+					{
+						integrate(bodies[0], bodies[i], substep, integrationMethod);
+					}
+					beltParticles.step(bodies[0]->mass, substep);
+					for (u32 i = 0; i < rings.size(); i++)
+					{
+						rings[i]->step(substep, ringTimeStep, maxRingStepsPerUpdate);
+					}
+					profiler.end(PROFILE_PHYSICS);
+
+					profiler.begin(PROFILE_COLLISIONS);
+					if (collisionsEnabled)
+					{
+						detectCollisions(bodies, previousPositions, collisions);
+						if (!collisions.empty())
+						{
+							array<Body*> removed;
+							resolveCollisions(bodies, collisions, collisionResponse, removed);
+							for (u32 i = 0; i < removed.size(); i++)
+							{
+								if (followCamera.getBody() == removed[i])
+								{
+									followCamera.stop();
+								}
+								for (u32 j = 0; j < rings.size(); j++)
+								{
+									if (rings[j]->planet == removed[i])
+									{
+										delete rings[j];
+										rings.erase(j);
+										break;
+									}
+								}
+								if (recorder)
+								{
+									recorder->bodyRemoved(removed[i]);
+								}
+								if (encounterMonitor)
+								{
+									encounterMonitor->bodyRemoved(removed[i]);
+								}
+								delete removed[i]->visual;
+								delete removed[i];
+							}
+						}
+					}
+
+					simulationTime += substep;
+					if (encounterMonitor)
+					{
+						encounterMonitor->update(bodies, simulationTime, substep);
+					}
+					profiler.end(PROFILE_COLLISIONS);
+
+					//Recorded per substep, so the spacing stays near the interval however many substeps an update takes.
+					if (recorder)
+					{
+						recorder->record(simulationTime);
+					}
+
+					//Whatever does not fit in the budget is dropped, so the frame rate holds and the warp effectively drops.
+					substepsTaken++;
+					if (!renderOffline && timer->getRealTime() - budgetStart >= msPhysicsBudget)
+					{
+						break;
+					}
 				}
-				integrate(bodies[0], bodies[i], timeStep);
+
+				lastUpdateDuration = substepsTaken * substep;
+				achievedWarp = elapsed > 0 ? lastUpdateDuration / (elapsed / 1000.0) : 0;
 			}
 			lastUpdateTime = currentTime;
 		}
 
-		if (currentTime - lastDrawTime >= msBetweenDraw)
+		if (renderOffline || currentTime - lastDrawTime >= msBetweenDraw)
 		{
 			driver->beginScene(true, true, SColor(255, 0, 0, 0));
 
+			profiler.begin(PROFILE_PREPARE_DRAW);
+			if (textureLoader)
+			{
+				textureLoader->update(bodies, textureUploadsPerFrame);
+			}
+			renderFrame.recenter(camera);
+			//A spline across a long update could cut through a large part of an orbit, however many substeps it took.
+			if (interpolateDraw && !renderOffline && fabs(lastUpdateDuration) <= maxInterpolatedSpan)
+			{
+				renderFrame.setInterpolation((double)(currentTime - lastUpdateTime) / msBetweenUpdate, lastUpdateDuration);
+			}
+			else
+			{
+				renderFrame.setInterpolation(1, 0);
+			}
+			followCamera.update(camera, renderFrame);
+			if (cameraPath)
+			{
+				cameraPath->update(framesRendered, bodies, camera, renderFrame);
+			}
+
+			//The FPS camera keeps the cursor in the middle of the screen, so this picks what is straight ahead.
+			if (input.wasLeftClicked())
+			{
+				picker.build(bodies, renderFrame, camera, driver->getScreenSize());
+				Body* picked = picker.pick(device->getCursorControl()->getPosition());
+				if (picked)
+				{
+					followCamera.follow(picked, camera, renderFrame);
+				}
+				else
+				{
+					followCamera.stop();
+				}
+			}
 			for (u32 i = 0; i < bodies.size(); i++)
 			{
-				bodies[i]->prepareDraw();
+				if (bodies[i]->visual)
+				{
+					bodies[i]->visual->prepareDraw(renderFrame);
+				}
 			}
+			for (u32 i = 0; i < rings.size(); i++)
+			{
+				rings[i]->prepareDraw(renderFrame);
+			}
+			if (planetShader)
+			{
+				planetShader->setSunPosition(renderFrame.toRender(renderFrame.drawPosition(bodies[0])));
+			}
+			if (cullingEnabled)
+			{
+				CullStats cullStats;
+				cullBodies(bodies, camera, driver->getScreenSize().Height, minPixelSize, cullStats);
+				profiler.count(PROFILE_BODIES_DRAWN, cullStats.bodiesDrawn);
+				profiler.count(PROFILE_BODIES_CULLED, cullStats.bodiesCulled);
+				profiler.count(PROFILE_TRAILS_DRAWN, cullStats.trailsDrawn);
+				profiler.count(PROFILE_TRAILS_CULLED, cullStats.trailsCulled);
+			}
+			sphereLod.update(bodies, camera, driver->getScreenSize().Height);
+			profiler.end(PROFILE_PREPARE_DRAW);
 
+			profiler.begin(PROFILE_DRAW_ALL);
 			smgr->drawAll();
+			if (showLabels)
+			{
+				labels.drawLabels(bodies, followCamera.getBody(), camera);
+				profiler.count(PROFILE_LABELS_DRAWN, labels.getLabelsDrawn());
+				profiler.count(PROFILE_LABELS_HIDDEN, labels.getLabelsHidden());
+			}
+			if (showHud && followCamera.getBody())
+			{
+				labels.drawReadouts(position2di(10, driver->getScreenSize().Height - 10));
+			}
 			guienv->drawAll();
+			profiler.end(PROFILE_DRAW_ALL);
 
+			profiler.begin(PROFILE_END_SCENE);
 			driver->endScene();
+			profiler.end(PROFILE_END_SCENE);
+
+			profiler.endFrame();
 
-			core::stringw str = L"Solar System [";
-			str += driver->getName();
-			str += L"] FPS: ";
-			str += (s32)driver->getFPS();
-			device->setWindowCaption(str.c_str());
+			if (frameWriter)
+			{
+				frameWriter->capture(framesRendered);
+				framesRendered++;
+				if (framesRendered >= offlineFrames)
+				{
+					device->closeDevice();
+				}
+			}
+
+			//Text is only rebuilt a few times per second, into a fixed buffer.
+			if (currentTime - lastOverlayTime >= msBetweenOverlay)
+			{
+				swprintf(caption, sizeof(caption) / sizeof(caption[0]), L"Solar System [%ls] FPS: %d Warp: %.3g days/s", driver->getName(), driver->getFPS(), achievedWarp / 86400);
+				device->setWindowCaption(caption);
+				profiler.updateOverlay(driver->getFPS());
+				if (showHud)
+				{
+					updateReadouts(labels, followCamera.getBody(), bodies[0]);
+				}
+				lastOverlayTime = currentTime;
+			}
 
 			lastDrawTime = currentTime;
 		}
 	}
 
+	delete encounterMonitor;
+	delete recorder;
+	delete replay;
+	for (u32 i = 0; i < rings.size(); i++)
+	{
+		delete rings[i];
+	}
+	delete textureLoader;
+	if (planetShader)
+	{
+		planetShader->drop();
+	}
+	if (frameWriter)
+	{
+		frameWriter->finish();
+		printf("Rendered %u frames, %u could not be saved\n", framesRendered, frameWriter->getFailed());
+		delete frameWriter;
+	}
+	delete cameraPath;
 	device->drop();
 
 	return 0;
 }
 
-void plotOrbit(Body* body, u32 plotInterval, u32 plotRadius, u32 nrOfPlotPoints, double distanceScale, IrrlichtDevice *device)
+//Trails and ellipses are built from the previous state, where the interpolated sphere starts, so they never run ahead of it.
+void plotOrbit(Body* body, double plotTolerance, u32 nrOfPlotPoints, const RenderFrame& renderFrame, IrrlichtDevice *device)
 {
-	bool addPlotPoint = false;
+	vector3d<double> position = renderFrame.toScaled(body->previousPosition);
+	BodyVisual* visual = body->visual;
 
-	if (body->orbitHistory.empty())
+	if (!visual->orbitTrail)
 	{
-		addPlotPoint = true;
+		ISceneManager* smgr = device->getSceneManager();
+		visual->orbitTrail = new OrbitTrailSceneNode(smgr->getRootSceneNode(), smgr, nrOfPlotPoints, plotTolerance, SColor(255, 255, 255, 255));
+		visual->orbitTrail->drop();
 	}
-	else
-	{
-		vector3df lastPlotPos = body->orbitHistory.getLast()->getPosition();
-		vector3d<double> lastToCurrent = vector3d<double>(
-			body->position.X * distanceScale -lastPlotPos.X,
-			body->position.Y * distanceScale - lastPlotPos.Y,
-			body->position.Z * distanceScale - lastPlotPos.Z
-			);
 
-		double distanceToCurrent = lastToCurrent.getLength();
-
-		if (distanceToCurrent >= plotInterval * plotRadius)
-		{
-			addPlotPoint = true;
-		}
+	//Points closer together than the tolerance could not change the shape of the trail.
+	if (visual->orbitTrail->size() == 0 || position.getDistanceFrom(visual->orbitTrail->getLast()) >= plotTolerance)
+	{
+		visual->orbitTrail->append(position);
 	}
+}
 
-	if (addPlotPoint)
+void plotOsculatingOrbit(Body* body, const Body* centralBody, u32 segments, double tolerance, const RenderFrame& renderFrame, IrrlichtDevice *device)
+{
+	BodyVisual* visual = body->visual;
+	if (!visual->orbitEllipse)
 	{
-		irr::scene::IMeshSceneNode* sphere = device->getSceneManager()->addSphereSceneNode(plotRadius, 8, 0, 1, vector3df(body->position.X, body->position.Y, body->position.Z) * distanceScale, vector3df(0), vector3df(1));
-		sphere->setMaterialFlag(irr::video::EMF_LIGHTING, false);
-		sphere->getMaterial(0).AmbientColor = video::SColor(255, 255, 255, 255);
-		body->orbitHistory.push_back(sphere);
-
-		if (body->orbitHistory.size() >= nrOfPlotPoints)
-		{	
-			body->orbitHistory[0]->remove();
-			body->orbitHistory.erase(0);
-		}
+		ISceneManager* smgr = device->getSceneManager();
+		visual->orbitEllipse = new OrbitEllipseSceneNode(smgr->getRootSceneNode(), smgr, segments, SColor(255, 255, 255, 255));
+		visual->orbitEllipse->drop();
 	}
+
+	//Bodies only feel the central body, so its mass alone sets the orbit.
+	visual->orbitEllipse->update(centralBody->previousPosition, body->previousPosition - centralBody->previousPosition, body->previousVelocity - centralBody->previousVelocity, G * centralBody->mass, tolerance, renderFrame);
 }
 
-void integrate(Body* body1, Body* body2, u32 timeStep)
+void updateReadouts(LabelRenderer& labels, const Body* body, const Body* centralBody)
 {
-	vector3d<double> acceleration;
-	if (EULER) {
-		acceleration = ((-G * body1->mass * body2->mass * body2->position) / pow(body2->position.getLength(), 3)) / body2->mass;
-		body2->position += body2->velocity * timeStep;
-		body2->velocity += acceleration * timeStep;
+	if (!body)
+	{
+		return;
 	}
 
-	else if (LEAPFROG) {
-		acceleration = ((-G * body1->mass * body2->mass * body2->position) / pow(body2->position.getLength(), 3)) / body2->mass;
-		body2->position += (body2->velocity * timeStep) + 0.5 * acceleration * pow(timeStep, 2);
-		vector3d<double> nextAcceleration = ((-G * body1->mass * body2->mass * body2->position) / pow(body2->position.getLength(), 3)) / body2->mass;
-		body2->velocity += 0.5 * (acceleration + nextAcceleration) * timeStep;
+	vector3d<double> relativePosition = body->position - centralBody->position;
+	vector3d<double> relativeVelocity = body->velocity - centralBody->velocity;
+	double mu = G * centralBody->mass;
+	OrbitalElements elements = orbitalElements(relativePosition, relativeVelocity, mu);
+
+	//Formatted into fixed buffers, the labels only lay the text out again when it changed.
+	wchar_t line[64];
+	labels.setReadout(0, body->name.c_str());
+	swprintf(line, 64, L"Distance: %.4f AU", relativePosition.getLength() / 1.495978707e11);
+	labels.setReadout(1, line);
+	swprintf(line, 64, L"Speed: %.3f km/s", relativeVelocity.getLength() / 1e3);
+	labels.setReadout(2, line);
+	if (elements.isBound())
+	{
+		swprintf(line, 64, L"Period: %.2f days", 2 * PI64 * sqrt(elements.semiMajorAxis * elements.semiMajorAxis * elements.semiMajorAxis / mu) / 86400);
 	}
-
-	else if (RK4) {
-		vector3d<double> pos1 = body2->position;
-		vector3d<double> acceleration1 = ((-G * body1->mass * body2->mass * pos1) / pow(pos1.getLength(), 3)) / body2->mass;
-		vector3d<double> velocity1 = body2->velocity;
-
-		vector3d<double> pos2 = pos1 + timeStep * velocity1 * 0.5;
-		vector3d<double> acceleration2 = ((-G * body1->mass * body2->mass * pos2) / pow(pos2.getLength(), 3)) / body2->mass;
-		vector3d<double> velocity2 = body2->velocity + timeStep * acceleration1 * 0.5;
-
-		vector3d<double> pos3 = pos2 + timeStep * velocity2 * 0.5;
-		vector3d<double> acceleration3 = ((-G * body1->mass * body2->mass * pos3) / pow(pos3.getLength(), 3)) / body2->mass;
-		vector3d<double> velocity3 = body2->velocity + timeStep * acceleration2 * 0.5;
-
-		vector3d<double> pos4 = pos3 + timeStep * velocity3;
-		vector3d<double> acceleration4 = ((-G * body1->mass * body2->mass * pos4) / pow(pos4.getLength(), 3)) / body2->mass;
-		vector3d<double> velocity4 = body2->velocity + timeStep * acceleration3;
-
-		body2->position += timeStep * (velocity1 + 2 * velocity2 + 2 * velocity3 + velocity4) / 6;
-		body2->velocity += timeStep * (acceleration1 + 2 * acceleration2 + 2 * acceleration3 + acceleration4) / 6;
+	else
+	{
+		swprintf(line, 64, L"Period: unbound");
 	}
+	labels.setReadout(3, line);
 }
-
-array<Body*> createBodies(IrrlichtDevice *device, u32 fixedPlanetDrawSize, double distanceScale)
-{
-	array<Body*> bodies;
-
-	//Data from A.D. 2000-Jan-01 00:00:00.0000 CT
-
-	bodies.push_back(
-		new Body(
-		"Sol",
-		vector3d<double>(0),
-		vector3d<double>(0),
-		6.955e8,
-		1.988544e30,
-		"resources/planet_textures/texture_sun.jpg",
-		distanceScale,
-		fixedPlanetDrawSize,
-		device
-		));
-
-	bodies.push_back(
-		new Body(
-		"Mercury",
-		vector3d<double>(-2.105262111032039E+10, -6.640663808353403E+10, -3.492446023382954E+09),
-		vector3d<double>(3.665298706393840E+04, -1.228983810111077E+04, -4.368172898981951E+03),
-		2440000,
-		3.302e23,
-		"resources/planet_textures/texture_mercury.jpg",
-		distanceScale,
-		fixedPlanetDrawSize,
-		device
-		));
-
-	bodies.push_back(
-		new Body(
-		"Venus",
-		vector3d<double>(-1.075055502695123E+11, -3.366520720591562E+09, 6.159219802771119E+09),
-		vector3d<double>(8.891598046362434E+02, -3.515920774124290E+04, -5.318594054684045E+02),
-		6051800,
-		48.685e23,
-		"resources/planet_textures/texture_venus_atmosphere.jpg",
-		distanceScale,
-		fixedPlanetDrawSize,
-		device
-		));
-
-	bodies.push_back(
-		new Body(
-		"Earth",
-		vector3d<double>(-2.521092863852298E+10, 1.449279195712076E+11, -6.164888475164771E+05),
-		vector3d<double>(-2.983983333368269E+04, -5.207633918704476E+03, 6.169062303484907E-02),
-		6371010,
-		5.97219e24,
-		"resources/planet_textures/texture_earth_surface.jpg",
-		distanceScale,
-		fixedPlanetDrawSize,
-		device
-		));
-
-	bodies.push_back(
-		new Body(
-		"Mars",
-		vector3d<double>(2.079950549908331E+11, -3.143009561106971E+09, -5.178781160069674E+09),
-		vector3d<double>(1.295003532851602E+03, 2.629442067068712E+04, 5.190097267545717E+02),
-		3389900,
-		6.4185e23,
-		"resources/planet_textures/texture_mars.jpg",
-		distanceScale,
-		fixedPlanetDrawSize,
-		device
-		));
-
-	bodies.push_back(
-		new Body(
-		"Jupiter",
-		vector3d<double>(5.989091594973032E+11, 4.391225931530510E+11, -1.523254614945272E+10),
-		vector3d<double>(-7.901937610713569E+03, 1.116317695450082E+04, 1.306729070868444E+02),
-		69911000,
-		1898.13e24,
-		"resources/planet_textures/texture_jupiter.jpg",
-		distanceScale,
-		fixedPlanetDrawSize,
-		device
-		));
-
-	bodies.push_back(
-		new Body(
-		"Saturn",
-		vector3d<double>(9.587063368200246E+11, 9.825652109121954E+11, -5.522065682385063E+10),
-		vector3d<double>(-7.428885683466339E+03, 6.738814237717373E+03, 1.776643613880609E+02),
-		58232000,
-		5.68319e26,
-		"resources/planet_textures/texture_saturn.jpg",
-		distanceScale,
-		fixedPlanetDrawSize,
-		device
-		));
-
-	bodies.push_back(
-		new Body(
-		"Uranus",
-		vector3d<double>(2.158774703477132E+12, -2.054825231595053E+12, -3.562348723541665E+10),
-		vector3d<double>(4.637648411798584E+03, 4.627192877193528E+03, -4.285025663198061E+01),
-		25362000,
-		86.8103e24,
-		"resources/planet_textures/texture_uranus.jpg",
-		distanceScale,
-		fixedPlanetDrawSize,
-		device
-		));
-
-	bodies.push_back(
-		new Body(
-		"Neptune",
-		vector3d<double>(2.514853420151505E+12, -3.738847412364252E+12, 1.903947325211763E+10),
-		vector3d<double>(4.465799984073191E+03, 3.075681163952201E+03, -1.665654118310400E+02),
-		24624000,
-		102.41e24,
-		"resources/planet_textures/texture_neptune.jpg",
-		distanceScale,
-		fixedPlanetDrawSize,
-		device
-		));
-
-	return bodies;
-}
\ No newline at end of file
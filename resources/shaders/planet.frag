@@ -0,0 +1,26 @@
+//Day surface lit by the Sun, city lights on the night side and clouds over both.
+uniform sampler2D dayMap;
+uniform sampler2D nightMap;
+uniform sampler2D cloudMap;
+uniform vec3 sunPosition;
+
+varying vec3 worldPosition;
+varying vec3 worldNormal;
+
+void main()
+{
+	vec2 uv = gl_TexCoord[0].xy;
+	float light = dot(normalize(worldNormal), normalize(sunPosition - worldPosition));
+	float diffuse = clamp(light, 0.0, 1.0);
+
+	//A soft terminator rather than a hard cut between the two sides.
+	float day = smoothstep(-0.15, 0.15, light);
+	float clouds = texture2D(cloudMap, uv).r;
+
+	vec3 dayColor = texture2D(dayMap, uv).rgb * (0.1 + 0.9 * diffuse);
+	vec3 nightColor = texture2D(nightMap, uv).rgb * (1.0 - clouds);
+	vec3 color = mix(nightColor, dayColor, day);
+	color = mix(color, vec3(diffuse), clouds * day);
+
+	gl_FragColor = vec4(color, 1.0);
+}
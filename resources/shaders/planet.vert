@@ -0,0 +1,13 @@
+//Passes the world space position and normal on for the day/night blend.
+uniform mat4 world;
+
+varying vec3 worldPosition;
+varying vec3 worldNormal;
+
+void main()
+{
+	gl_Position = ftransform();
+	gl_TexCoord[0] = gl_MultiTexCoord0;
+	worldPosition = (world * gl_Vertex).xyz;
+	worldNormal = (world * vec4(gl_Normal, 0.0)).xyz;
+}